@@ -0,0 +1 @@
+gcc  -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="actual"   -M bench-alloc.c | sed 's,\(bench-alloc\.o\) *:,.bench-alloc-actual/ .bench-alloc-actual/bench-alloc.d: ,' > .bench-alloc-actual/bench-alloc.d; cp -rf .bench-alloc-actual/bench-alloc.d .bench-alloc-actual/bench-alloc.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .bench-alloc-actual/bench-alloc.d >> .bench-alloc-actual/bench-alloc.d.p; mv .bench-alloc-actual/bench-alloc.d.p .bench-alloc-actual/bench-alloc.d
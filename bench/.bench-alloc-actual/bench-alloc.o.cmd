@@ -0,0 +1 @@
+gcc  -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="actual"    -c -o .bench-alloc-actual/bench-alloc.o bench-alloc.c
@@ -0,0 +1 @@
+gcc  -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1   -o .bench-alloc-asan/bench-alloc-asan .bench-alloc-asan/bench-alloc.o -fsanitize=address -lpthread 
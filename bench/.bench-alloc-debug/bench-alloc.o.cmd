@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="debug" -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src  -c -o .bench-alloc-debug/bench-alloc.o bench-alloc.c
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="actual"   -M bench-calloc.c | sed 's,\(bench-calloc\.o\) *:,.bench-calloc-actual/ .bench-calloc-actual/bench-calloc.d: ,' > .bench-calloc-actual/bench-calloc.d; cp -rf .bench-calloc-actual/bench-calloc.d .bench-calloc-actual/bench-calloc.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .bench-calloc-actual/bench-calloc.d >> .bench-calloc-actual/bench-calloc.d.p; mv .bench-calloc-actual/bench-calloc.d.p .bench-calloc-actual/bench-calloc.d
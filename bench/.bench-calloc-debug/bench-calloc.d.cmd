@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="debug" -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M bench-calloc.c | sed 's,\(bench-calloc\.o\) *:,.bench-calloc-debug/ .bench-calloc-debug/bench-calloc.d: ,' > .bench-calloc-debug/bench-calloc.d; cp -rf .bench-calloc-debug/bench-calloc.d .bench-calloc-debug/bench-calloc.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .bench-calloc-debug/bench-calloc.d >> .bench-calloc-debug/bench-calloc.d.p; mv .bench-calloc-debug/bench-calloc.d.p .bench-calloc-debug/bench-calloc.d
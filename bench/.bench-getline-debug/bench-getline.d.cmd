@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="debug" -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M bench-getline.c | sed 's,\(bench-getline\.o\) *:,.bench-getline-debug/ .bench-getline-debug/bench-getline.d: ,' > .bench-getline-debug/bench-getline.d; cp -rf .bench-getline-debug/bench-getline.d .bench-getline-debug/bench-getline.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .bench-getline-debug/bench-getline.d >> .bench-getline-debug/bench-getline.d.p; mv .bench-getline-debug/bench-getline.d.p .bench-getline-debug/bench-getline.d
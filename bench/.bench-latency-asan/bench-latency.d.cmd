@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="asan" -fsanitize=address -fno-omit-frame-pointer   -M bench-latency.c | sed 's,\(bench-latency\.o\) *:,.bench-latency-asan/ .bench-latency-asan/bench-latency.d: ,' > .bench-latency-asan/bench-latency.d; cp -rf .bench-latency-asan/bench-latency.d .bench-latency-asan/bench-latency.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .bench-latency-asan/bench-latency.d >> .bench-latency-asan/bench-latency.d.p; mv .bench-latency-asan/bench-latency.d.p .bench-latency-asan/bench-latency.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="debug" -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M bench-latency.c | sed 's,\(bench-latency\.o\) *:,.bench-latency-debug/ .bench-latency-debug/bench-latency.d: ,' > .bench-latency-debug/bench-latency.d; cp -rf .bench-latency-debug/bench-latency.d .bench-latency-debug/bench-latency.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .bench-latency-debug/bench-latency.d >> .bench-latency-debug/bench-latency.d.p; mv .bench-latency-debug/bench-latency.d.p .bench-latency-debug/bench-latency.d
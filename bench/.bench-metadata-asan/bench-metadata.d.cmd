@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="asan" -fsanitize=address -fno-omit-frame-pointer   -M bench-metadata.c | sed 's,\(bench-metadata\.o\) *:,.bench-metadata-asan/ .bench-metadata-asan/bench-metadata.d: ,' > .bench-metadata-asan/bench-metadata.d; cp -rf .bench-metadata-asan/bench-metadata.d .bench-metadata-asan/bench-metadata.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .bench-metadata-asan/bench-metadata.d >> .bench-metadata-asan/bench-metadata.d.p; mv .bench-metadata-asan/bench-metadata.d.p .bench-metadata-asan/bench-metadata.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="actual"   -M bench-realloc.c | sed 's,\(bench-realloc\.o\) *:,.bench-realloc-actual/ .bench-realloc-actual/bench-realloc.d: ,' > .bench-realloc-actual/bench-realloc.d; cp -rf .bench-realloc-actual/bench-realloc.d .bench-realloc-actual/bench-realloc.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .bench-realloc-actual/bench-realloc.d >> .bench-realloc-actual/bench-realloc.d.p; mv .bench-realloc-actual/bench-realloc.d.p .bench-realloc-actual/bench-realloc.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="debug" -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M bench-realloc.c | sed 's,\(bench-realloc\.o\) *:,.bench-realloc-debug/ .bench-realloc-debug/bench-realloc.d: ,' > .bench-realloc-debug/bench-realloc.d; cp -rf .bench-realloc-debug/bench-realloc.d .bench-realloc-debug/bench-realloc.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .bench-realloc-debug/bench-realloc.d >> .bench-realloc-debug/bench-realloc.d.p; mv .bench-realloc-debug/bench-realloc.d.p .bench-realloc-debug/bench-realloc.d
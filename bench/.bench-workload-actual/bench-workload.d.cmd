@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O2 -DBENCH_BUILD="actual"   -M bench-workload.c | sed 's,\(bench-workload\.o\) *:,.bench-workload-actual/ .bench-workload-actual/bench-workload.d: ,' > .bench-workload-actual/bench-workload.d; cp -rf .bench-workload-actual/bench-workload.d .bench-workload-actual/bench-workload.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .bench-workload-actual/bench-workload.d >> .bench-workload-actual/bench-workload.d.p; mv .bench-workload-actual/bench-workload.d.p .bench-workload-actual/bench-workload.d
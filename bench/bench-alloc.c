@@ -0,0 +1,359 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <stdint.h>
+
+#if !defined(BENCH_BUILD)
+#define BENCH_BUILD		"plain"
+#endif
+
+#define BENCH_BATCH		256
+#define BENCH_SAMPLES		4096
+#define BENCH_LIST_MAX		32
+
+enum {
+	BENCH_OP_MALLOC,
+	BENCH_OP_FREE,
+	BENCH_OP_CALLOC,
+	BENCH_OP_REALLOC,
+	BENCH_OP_STRDUP,
+	BENCH_OP_MAX
+};
+
+static const char *bench_op_names[BENCH_OP_MAX] = {
+	"malloc",
+	"free",
+	"calloc",
+	"realloc",
+	"strdup",
+};
+
+struct bench_result {
+	unsigned long long ops;
+	unsigned long long ns;
+	unsigned long long samples[BENCH_SAMPLES];
+	unsigned long long seen;
+	unsigned int nsamples;
+	unsigned int seed;
+};
+
+struct bench_thread {
+	pthread_t thread;
+	int op;
+	size_t size;
+	unsigned long long iterations;
+	const char *string;
+	pthread_barrier_t *barrier;
+	struct bench_result result;
+};
+
+static inline unsigned long long bench_clock (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * keeps a uniform sample of all batches (reservoir sampling), so that
+ * percentiles of long runs are not dominated by the first batches.
+ */
+static inline void bench_sample (struct bench_result *result, unsigned long long ns, unsigned int ops)
+{
+	unsigned long long i;
+	result->seen += 1;
+	if (result->nsamples < BENCH_SAMPLES) {
+		result->samples[result->nsamples++] = ns / ops;
+		return;
+	}
+	i = ((((unsigned long long) rand_r(&result->seed)) << 31) ^ rand_r(&result->seed)) % result->seen;
+	if (i < BENCH_SAMPLES) {
+		result->samples[i] = ns / ops;
+	}
+}
+
+static void * bench_worker (void *arg)
+{
+	unsigned int i;
+	unsigned long long n;
+	unsigned long long t0;
+	unsigned long long t1;
+	unsigned long long t2;
+	void *blocks[BENCH_BATCH];
+	struct bench_thread *t;
+	struct bench_result *alloc;
+	struct bench_result *release;
+	struct bench_result dummy;
+	t = arg;
+	alloc = &t->result;
+	release = (t->op == BENCH_OP_FREE) ? &t->result : &dummy;
+	memset(&dummy, 0, sizeof(dummy));
+	alloc->seed = (unsigned int) (uintptr_t) t;
+	dummy.seed = alloc->seed + 1;
+	pthread_barrier_wait(t->barrier);
+	for (n = 0; n < t->iterations; n += BENCH_BATCH) {
+		t0 = bench_clock();
+		for (i = 0; i < BENCH_BATCH; i++) {
+			switch (t->op) {
+				case BENCH_OP_MALLOC:
+				case BENCH_OP_FREE:
+					blocks[i] = malloc(t->size);
+					break;
+				case BENCH_OP_CALLOC:
+					blocks[i] = calloc(1, t->size);
+					break;
+				case BENCH_OP_REALLOC:
+					blocks[i] = realloc(NULL, t->size / 2 + 1);
+					blocks[i] = realloc(blocks[i], t->size);
+					break;
+				case BENCH_OP_STRDUP:
+					blocks[i] = strdup(t->string);
+					break;
+			}
+			if (blocks[i] == NULL) {
+				fprintf(stderr, "%s failed\n", bench_op_names[t->op]);
+				exit(-1);
+			}
+		}
+		t1 = bench_clock();
+		for (i = 0; i < BENCH_BATCH; i++) {
+			free(blocks[i]);
+		}
+		t2 = bench_clock();
+		if (t->op != BENCH_OP_FREE) {
+			alloc->ns += t1 - t0;
+			alloc->ops += BENCH_BATCH;
+			bench_sample(alloc, t1 - t0, BENCH_BATCH);
+		}
+		release->ns += t2 - t1;
+		release->ops += BENCH_BATCH;
+		bench_sample(release, t2 - t1, BENCH_BATCH);
+	}
+	return NULL;
+}
+
+static int bench_compare (const void *a, const void *b)
+{
+	unsigned long long x = *(const unsigned long long *) a;
+	unsigned long long y = *(const unsigned long long *) b;
+	return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+static int bench_run (int op, size_t size, unsigned int threads, unsigned long long live, unsigned long long iterations)
+{
+	int rc;
+	unsigned int i;
+	unsigned int j;
+	char *string;
+	unsigned long long ns;
+	unsigned long long ops;
+	unsigned long long wall;
+	unsigned long long *samples;
+	unsigned int nsamples;
+	pthread_barrier_t barrier;
+	struct bench_thread *t;
+	string = NULL;
+	if (op == BENCH_OP_STRDUP) {
+		string = malloc(size);
+		if (string == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			return -1;
+		}
+		memset(string, 'a', size - 1);
+		string[size - 1] = '\0';
+	}
+	t = calloc(threads, sizeof(struct bench_thread));
+	samples = calloc(threads, sizeof(unsigned long long) * BENCH_SAMPLES);
+	if (t == NULL || samples == NULL) {
+		fprintf(stderr, "calloc failed\n");
+		return -1;
+	}
+	pthread_barrier_init(&barrier, NULL, threads + 1);
+	for (i = 0; i < threads; i++) {
+		t[i].op = op;
+		t[i].size = size;
+		t[i].string = string;
+		t[i].iterations = iterations / threads;
+		t[i].barrier = &barrier;
+		rc = pthread_create(&t[i].thread, NULL, bench_worker, &t[i]);
+		if (rc != 0) {
+			fprintf(stderr, "pthread_create failed\n");
+			return -1;
+		}
+	}
+	wall = bench_clock();
+	pthread_barrier_wait(&barrier);
+	for (i = 0; i < threads; i++) {
+		pthread_join(t[i].thread, NULL);
+	}
+	wall = bench_clock() - wall;
+	pthread_barrier_destroy(&barrier);
+	ns = 0;
+	ops = 0;
+	nsamples = 0;
+	for (i = 0; i < threads; i++) {
+		ns += t[i].result.ns;
+		ops += t[i].result.ops;
+		for (j = 0; j < t[i].result.nsamples; j++) {
+			samples[nsamples++] = t[i].result.samples[j];
+		}
+	}
+	qsort(samples, nsamples, sizeof(unsigned long long), bench_compare);
+	printf("%s,%s,%zu,%u,%llu,%llu,%.06f,%.0f,%.1f,%llu,%llu\n",
+		BENCH_BUILD,
+		bench_op_names[op],
+		size,
+		threads,
+		live,
+		ops,
+		((double) wall) / 1e9,
+		((double) ops) * 1e9 / wall,
+		((double) ns) / ops,
+		(nsamples == 0) ? 0 : samples[nsamples / 2],
+		(nsamples == 0) ? 0 : samples[(nsamples * 99) / 100]);
+	fflush(stdout);
+	free(samples);
+	free(t);
+	free(string);
+	return 0;
+}
+
+static int bench_parse_list (const char *arg, unsigned long long *list)
+{
+	int n;
+	char *end;
+	for (n = 0; *arg != '\0' && n < BENCH_LIST_MAX; n++) {
+		list[n] = strtoull(arg, &end, 0);
+		if (*end == 'k' || *end == 'K') {
+			list[n] *= 1024;
+			end++;
+		} else if (*end == 'm' || *end == 'M') {
+			list[n] *= 1024 * 1024;
+			end++;
+		}
+		if (*end == ',') {
+			end++;
+		}
+		arg = end;
+	}
+	return n;
+}
+
+static void bench_usage (const char *name)
+{
+	fprintf(stderr, "usage: %s [options]\n", name);
+	fprintf(stderr, "  -s, --sizes      : comma separated block sizes (default: 8,64,512,4k,32k,256k,1m)\n");
+	fprintf(stderr, "  -t, --threads    : comma separated thread counts (default: 1,2,4,..,nproc)\n");
+	fprintf(stderr, "  -l, --live       : comma separated live block counts (default: 1000,10000,100000,1000000,10000000)\n");
+	fprintf(stderr, "  -i, --iterations : operations per measurement (default: 262144)\n");
+	fprintf(stderr, "  -n, --no-header  : do not print csv header\n");
+	fprintf(stderr, "  -h, --help       : this text\n");
+}
+
+int main (int argc, char *argv[])
+{
+	int c;
+	int op;
+	int header;
+	int nsizes;
+	int nthreads;
+	int nlives;
+	long cpus;
+	unsigned long long l;
+	unsigned long long k;
+	unsigned long long iterations;
+	unsigned long long sizes[BENCH_LIST_MAX] = { 8, 64, 512, 4096, 32768, 262144, 1048576 };
+	unsigned long long threads[BENCH_LIST_MAX];
+	unsigned long long lives[BENCH_LIST_MAX] = { 1000, 10000, 100000, 1000000, 10000000 };
+	void **live;
+	struct option options[] = {
+		{ "sizes", required_argument, NULL, 's' },
+		{ "threads", required_argument, NULL, 't' },
+		{ "live", required_argument, NULL, 'l' },
+		{ "iterations", required_argument, NULL, 'i' },
+		{ "no-header", no_argument, NULL, 'n' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	header = 1;
+	nsizes = 7;
+	nlives = 5;
+	iterations = 262144;
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	for (nthreads = 0, l = 1; l <= (unsigned long long) ((cpus < 1) ? 1 : cpus); l *= 2) {
+		threads[nthreads++] = l;
+	}
+	if (threads[nthreads - 1] != (unsigned long long) cpus && cpus > 1) {
+		threads[nthreads++] = cpus;
+	}
+	while ((c = getopt_long(argc, argv, "s:t:l:i:nh", options, NULL)) != -1) {
+		switch (c) {
+			case 's': nsizes = bench_parse_list(optarg, sizes); break;
+			case 't': nthreads = bench_parse_list(optarg, threads); break;
+			case 'l': nlives = bench_parse_list(optarg, lives); break;
+			case 'i': iterations = strtoull(optarg, NULL, 0); break;
+			case 'n': header = 0; break;
+			case 'h': bench_usage(argv[0]); return 0;
+			default: bench_usage(argv[0]); return -1;
+		}
+	}
+	if (iterations < BENCH_BATCH) {
+		iterations = BENCH_BATCH;
+	}
+	if (header) {
+		printf("build,op,size,threads,live,ops,seconds,ops_per_sec,ns_per_op,p50_ns,p99_ns\n");
+	}
+	for (op = 0; op < BENCH_OP_MAX; op++) {
+		for (c = 0; c < nsizes; c++) {
+			for (k = 0; k < (unsigned long long) nthreads; k++) {
+				unsigned long long n;
+				n = iterations;
+				if (sizes[c] >= 32768) {
+					n = iterations / 16;
+				}
+				n = (n < threads[k] * BENCH_BATCH) ? threads[k] * BENCH_BATCH : n;
+				if (bench_run(op, sizes[c], threads[k], 0, n) != 0) {
+					return -1;
+				}
+			}
+		}
+	}
+	for (c = 0; c < nlives; c++) {
+		live = malloc(sizeof(void *) * lives[c]);
+		if (live == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			return -1;
+		}
+		for (l = 0; l < lives[c]; l++) {
+			live[l] = malloc(32);
+			if (live[l] == NULL) {
+				fprintf(stderr, "malloc failed\n");
+				return -1;
+			}
+		}
+		for (op = BENCH_OP_MALLOC; op <= BENCH_OP_FREE; op++) {
+			if (bench_run(op, 64, 1, lives[c], iterations) != 0) {
+				return -1;
+			}
+		}
+		for (l = 0; l < lives[c]; l++) {
+			free(live[l]);
+		}
+		free(live);
+	}
+	return 0;
+}
@@ -0,0 +1,182 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <time.h>
+
+#if !defined(BENCH_BUILD)
+#define BENCH_BUILD		"plain"
+#endif
+
+#define CALLOC_LIST_MAX		32
+
+static inline unsigned long long calloc_clock (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static long long calloc_resident (void)
+{
+	FILE *fp;
+	long long size;
+	long long resident;
+	fp = fopen("/proc/self/statm", "r");
+	if (fp == NULL) {
+		return -1;
+	}
+	if (fscanf(fp, "%lld %lld", &size, &resident) != 2) {
+		resident = -1;
+	}
+	fclose(fp);
+	return (resident < 0) ? -1 : resident * sysconf(_SC_PAGESIZE);
+}
+
+/*
+ * large zeroed buffers of which only a few pages are ever written, like
+ * sparse tables and bitmaps. resident memory is sampled while all blocks
+ * are live, it grows with the size of the blocks only if calloc clears
+ * memory that the kernel already handed out zeroed.
+ */
+static int calloc_run (size_t size, unsigned int blocks, unsigned int touch)
+{
+	unsigned int i;
+	unsigned int j;
+	size_t page;
+	char **b;
+	long long r0;
+	long long r1;
+	unsigned long long t0;
+	unsigned long long t1;
+	unsigned long long t2;
+	page = sysconf(_SC_PAGESIZE);
+	b = malloc(sizeof(char *) * blocks);
+	if (b == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		return -1;
+	}
+	r0 = calloc_resident();
+	t0 = calloc_clock();
+	for (i = 0; i < blocks; i++) {
+		b[i] = calloc(1, size);
+		if (b[i] == NULL) {
+			fprintf(stderr, "calloc failed\n");
+			return -1;
+		}
+	}
+	t1 = calloc_clock();
+	for (i = 0; i < blocks; i++) {
+		for (j = 0; j < touch; j++) {
+			b[i][(((size_t) j) * 7919 * page) % size] = 1;
+		}
+	}
+	r1 = calloc_resident();
+	t2 = calloc_clock();
+	for (i = 0; i < blocks; i++) {
+		free(b[i]);
+	}
+	t2 = calloc_clock() - t2;
+	printf("%s,%zu,%u,%u,%.06f,%.0f,%.0f,%lld\n",
+		BENCH_BUILD,
+		size,
+		blocks,
+		touch,
+		((double) (t1 - t0)) / 1e9,
+		((double) (t1 - t0)) / blocks,
+		((double) t2) / blocks,
+		(r0 < 0 || r1 < 0) ? -1 : (r1 - r0) / 1024);
+	fflush(stdout);
+	free(b);
+	return 0;
+}
+
+static int calloc_parse_list (const char *arg, unsigned long long *list)
+{
+	int n;
+	char *end;
+	for (n = 0; *arg != '\0' && n < CALLOC_LIST_MAX; n++) {
+		list[n] = strtoull(arg, &end, 0);
+		if (*end == 'k' || *end == 'K') {
+			list[n] *= 1024;
+			end++;
+		} else if (*end == 'm' || *end == 'M') {
+			list[n] *= 1024 * 1024;
+			end++;
+		}
+		if (*end == ',') {
+			end++;
+		}
+		arg = end;
+	}
+	return n;
+}
+
+static void calloc_usage (const char *name)
+{
+	fprintf(stderr, "usage: %s [options]\n", name);
+	fprintf(stderr, "  -s, --sizes     : comma separated block sizes (default: 4k,256k,1m,16m,64m)\n");
+	fprintf(stderr, "  -b, --blocks    : blocks allocated per size (default: 16)\n");
+	fprintf(stderr, "  -p, --pages     : comma separated pages written per block (default: 0,1,16)\n");
+	fprintf(stderr, "  -n, --no-header : do not print csv header\n");
+	fprintf(stderr, "  -h, --help      : this text\n");
+}
+
+int main (int argc, char *argv[])
+{
+	int c;
+	int p;
+	int header;
+	int nsizes;
+	int npages;
+	unsigned int blocks;
+	unsigned long long sizes[CALLOC_LIST_MAX] = { 4096, 262144, 1048576, 16777216, 67108864 };
+	unsigned long long pages[CALLOC_LIST_MAX] = { 0, 1, 16 };
+	struct option options[] = {
+		{ "sizes", required_argument, NULL, 's' },
+		{ "blocks", required_argument, NULL, 'b' },
+		{ "pages", required_argument, NULL, 'p' },
+		{ "no-header", no_argument, NULL, 'n' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	header = 1;
+	nsizes = 5;
+	npages = 3;
+	blocks = 16;
+	while ((c = getopt_long(argc, argv, "s:b:p:nh", options, NULL)) != -1) {
+		switch (c) {
+			case 's': nsizes = calloc_parse_list(optarg, sizes); break;
+			case 'b': blocks = strtoul(optarg, NULL, 0); break;
+			case 'p': npages = calloc_parse_list(optarg, pages); break;
+			case 'n': header = 0; break;
+			case 'h': calloc_usage(argv[0]); return 0;
+			default: calloc_usage(argv[0]); return -1;
+		}
+	}
+	if (blocks == 0) {
+		blocks = 1;
+	}
+	if (header) {
+		printf("build,size,blocks,pages,seconds,ns_per_calloc,ns_per_free,resident_kb\n");
+	}
+	for (c = 0; c < nsizes; c++) {
+		for (p = 0; p < npages; p++) {
+			if (calloc_run(sizes[c], blocks, pages[p]) != 0) {
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,159 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+
+#if !defined(BENCH_BUILD)
+#define BENCH_BUILD		"plain"
+#endif
+
+#define GETLINE_LIST_MAX	32
+
+static inline unsigned long long getline_clock (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * a log parsing loop, lines of random length around the given mean are
+ * written to a temporary file once and read back with a single reused
+ * getline buffer.
+ */
+static int getline_run (size_t length, unsigned long long bytes)
+{
+	FILE *fp;
+	char *l;
+	size_t n;
+	size_t s;
+	ssize_t r;
+	unsigned long long i;
+	unsigned long long t0;
+	unsigned long long t1;
+	unsigned long long lines;
+	unsigned long long total;
+	char *text;
+	text = malloc(length * 2 + 1);
+	if (text == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		return -1;
+	}
+	memset(text, 'a', length * 2);
+	fp = tmpfile();
+	if (fp == NULL) {
+		fprintf(stderr, "tmpfile failed\n");
+		return -1;
+	}
+	srand(length);
+	for (i = 0; i < bytes; i += s + 1) {
+		s = length / 2 + (rand() % (length + 1));
+		fwrite(text, 1, s, fp);
+		fputc('\n', fp);
+	}
+	free(text);
+	rewind(fp);
+	l = NULL;
+	n = 0;
+	lines = 0;
+	total = 0;
+	t0 = getline_clock();
+	while ((r = getline(&l, &n, fp)) > 0) {
+		lines += 1;
+		total += r;
+	}
+	t1 = getline_clock();
+	free(l);
+	fclose(fp);
+	printf("%s,%zu,%llu,%llu,%.06f,%.1f,%.1f\n",
+		BENCH_BUILD,
+		length,
+		lines,
+		total,
+		((double) (t1 - t0)) / 1e9,
+		(lines == 0) ? 0.0 : ((double) (t1 - t0)) / lines,
+		((double) total) * 1e3 / (t1 - t0));
+	fflush(stdout);
+	return 0;
+}
+
+static int getline_parse_list (const char *arg, unsigned long long *list)
+{
+	int n;
+	char *end;
+	for (n = 0; *arg != '\0' && n < GETLINE_LIST_MAX; n++) {
+		list[n] = strtoull(arg, &end, 0);
+		if (*end == 'k' || *end == 'K') {
+			list[n] *= 1024;
+			end++;
+		} else if (*end == 'm' || *end == 'M') {
+			list[n] *= 1024 * 1024;
+			end++;
+		}
+		if (*end == ',') {
+			end++;
+		}
+		arg = end;
+	}
+	return n;
+}
+
+static void getline_usage (const char *name)
+{
+	fprintf(stderr, "usage: %s [options]\n", name);
+	fprintf(stderr, "  -l, --lengths   : comma separated mean line lengths (default: 16,80,1k,64k)\n");
+	fprintf(stderr, "  -b, --bytes     : bytes read per line length (default: 64m)\n");
+	fprintf(stderr, "  -n, --no-header : do not print csv header\n");
+	fprintf(stderr, "  -h, --help      : this text\n");
+}
+
+int main (int argc, char *argv[])
+{
+	int c;
+	int header;
+	int nlengths;
+	unsigned long long bytes;
+	unsigned long long lengths[GETLINE_LIST_MAX] = { 16, 80, 1024, 65536 };
+	struct option options[] = {
+		{ "lengths", required_argument, NULL, 'l' },
+		{ "bytes", required_argument, NULL, 'b' },
+		{ "no-header", no_argument, NULL, 'n' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	header = 1;
+	nlengths = 4;
+	bytes = 64 * 1024 * 1024;
+	while ((c = getopt_long(argc, argv, "l:b:nh", options, NULL)) != -1) {
+		switch (c) {
+			case 'l': nlengths = getline_parse_list(optarg, lengths); break;
+			case 'b': getline_parse_list(optarg, &bytes); break;
+			case 'n': header = 0; break;
+			case 'h': getline_usage(argv[0]); return 0;
+			default: getline_usage(argv[0]); return -1;
+		}
+	}
+	if (header) {
+		printf("build,length,lines,bytes,seconds,ns_per_line,mb_per_sec\n");
+	}
+	for (c = 0; c < nlengths; c++) {
+		if (lengths[c] == 0) {
+			continue;
+		}
+		if (getline_run(lengths[c], bytes) != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
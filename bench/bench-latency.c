@@ -0,0 +1,214 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+
+#if !defined(BENCH_BUILD)
+#define BENCH_BUILD		"plain"
+#endif
+
+#define BENCH_LIST_MAX		32
+
+struct bench_thread {
+	pthread_t thread;
+	size_t size;
+	unsigned long long blocks;
+	void **live;
+	unsigned long long *samples;
+	pthread_barrier_t *barrier;
+};
+
+static inline unsigned long long bench_clock (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static void * bench_worker (void *arg)
+{
+	unsigned long long n;
+	unsigned long long t0;
+	unsigned long long t1;
+	struct bench_thread *t;
+	t = arg;
+	pthread_barrier_wait(t->barrier);
+	for (n = 0; n < t->blocks; n++) {
+		t0 = bench_clock();
+		t->live[n] = malloc(t->size);
+		t1 = bench_clock();
+		if (t->live[n] == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			exit(-1);
+		}
+		t->samples[n] = t1 - t0;
+	}
+	pthread_barrier_wait(t->barrier);
+	for (n = 0; n < t->blocks; n++) {
+		free(t->live[n]);
+	}
+	return NULL;
+}
+
+static int bench_compare (const void *a, const void *b)
+{
+	unsigned long long x = *(const unsigned long long *) a;
+	unsigned long long y = *(const unsigned long long *) b;
+	return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+static int bench_run (size_t size, unsigned int threads, unsigned long long blocks)
+{
+	int rc;
+	unsigned int i;
+	unsigned long long n;
+	unsigned long long ns;
+	unsigned long long wall;
+	unsigned long long *samples;
+	void **live;
+	pthread_barrier_t barrier;
+	struct bench_thread *t;
+	blocks = (blocks / threads) * threads;
+	t = calloc(threads, sizeof(struct bench_thread));
+	live = malloc(sizeof(void *) * blocks);
+	samples = malloc(sizeof(unsigned long long) * blocks);
+	if (t == NULL || live == NULL || samples == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		return -1;
+	}
+	/* touch the sample and block arrays so that page faults are not timed */
+	memset(live, 0, sizeof(void *) * blocks);
+	memset(samples, 0, sizeof(unsigned long long) * blocks);
+	pthread_barrier_init(&barrier, NULL, threads + 1);
+	for (i = 0; i < threads; i++) {
+		t[i].size = size;
+		t[i].blocks = blocks / threads;
+		t[i].live = live + i * (blocks / threads);
+		t[i].samples = samples + i * (blocks / threads);
+		t[i].barrier = &barrier;
+		rc = pthread_create(&t[i].thread, NULL, bench_worker, &t[i]);
+		if (rc != 0) {
+			fprintf(stderr, "pthread_create failed\n");
+			return -1;
+		}
+	}
+	wall = bench_clock();
+	pthread_barrier_wait(&barrier);
+	pthread_barrier_wait(&barrier);
+	wall = bench_clock() - wall;
+	for (i = 0; i < threads; i++) {
+		pthread_join(t[i].thread, NULL);
+	}
+	pthread_barrier_destroy(&barrier);
+	for (ns = 0, n = 0; n < blocks; n++) {
+		ns += samples[n];
+	}
+	qsort(samples, blocks, sizeof(unsigned long long), bench_compare);
+	printf("%s,%zu,%u,%llu,%.06f,%.1f,%llu,%llu,%llu,%llu\n",
+		BENCH_BUILD,
+		size,
+		threads,
+		blocks,
+		((double) wall) / 1e9,
+		((double) ns) / blocks,
+		samples[blocks / 2],
+		samples[(blocks * 99) / 100],
+		samples[(blocks * 999) / 1000],
+		samples[blocks - 1]);
+	fflush(stdout);
+	free(samples);
+	free(live);
+	free(t);
+	return 0;
+}
+
+static int bench_parse_list (const char *arg, unsigned long long *list)
+{
+	int n;
+	char *end;
+	for (n = 0; *arg != '\0' && n < BENCH_LIST_MAX; n++) {
+		list[n] = strtoull(arg, &end, 0);
+		if (*end == 'k' || *end == 'K') {
+			list[n] *= 1024;
+			end++;
+		} else if (*end == 'm' || *end == 'M') {
+			list[n] *= 1024 * 1024;
+			end++;
+		}
+		if (*end == ',') {
+			end++;
+		}
+		arg = end;
+	}
+	return n;
+}
+
+static void bench_usage (const char *name)
+{
+	fprintf(stderr, "usage: %s [options]\n", name);
+	fprintf(stderr, "  -b, --blocks     : comma separated block counts to grow to (default: 100000,1000000,4000000)\n");
+	fprintf(stderr, "  -s, --size       : block size (default: 32)\n");
+	fprintf(stderr, "  -t, --threads    : comma separated thread counts (default: 1,4)\n");
+	fprintf(stderr, "  -n, --no-header  : do not print csv header\n");
+	fprintf(stderr, "  -h, --help       : this text\n");
+}
+
+int main (int argc, char *argv[])
+{
+	int c;
+	int k;
+	int header;
+	int nblocks;
+	int nthreads;
+	size_t size;
+	unsigned long long blocks[BENCH_LIST_MAX] = { 100000, 1000000, 4000000 };
+	unsigned long long threads[BENCH_LIST_MAX] = { 1, 4 };
+	struct option options[] = {
+		{ "blocks", required_argument, NULL, 'b' },
+		{ "size", required_argument, NULL, 's' },
+		{ "threads", required_argument, NULL, 't' },
+		{ "no-header", no_argument, NULL, 'n' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	header = 1;
+	nblocks = 3;
+	nthreads = 2;
+	size = 32;
+	while ((c = getopt_long(argc, argv, "b:s:t:nh", options, NULL)) != -1) {
+		switch (c) {
+			case 'b': nblocks = bench_parse_list(optarg, blocks); break;
+			case 's': size = strtoull(optarg, NULL, 0); break;
+			case 't': nthreads = bench_parse_list(optarg, threads); break;
+			case 'n': header = 0; break;
+			case 'h': bench_usage(argv[0]); return 0;
+			default: bench_usage(argv[0]); return -1;
+		}
+	}
+	if (header) {
+		printf("build,size,threads,blocks,seconds,ns_per_op,p50_ns,p99_ns,p999_ns,max_ns\n");
+	}
+	for (c = 0; c < nblocks; c++) {
+		for (k = 0; k < nthreads; k++) {
+			if (threads[k] == 0 || blocks[c] < threads[k]) {
+				continue;
+			}
+			if (bench_run(size, threads[k], blocks[c]) != 0) {
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
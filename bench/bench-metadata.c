@@ -0,0 +1,315 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#if !defined(BENCH_BUILD)
+#define BENCH_BUILD		"plain"
+#endif
+
+#define BENCH_LIST_MAX		32
+#define BENCH_METADATA_NAME	"hmemory_metadata_region"
+
+enum {
+	BENCH_COUNTER_DTLB,
+	BENCH_COUNTER_CACHE,
+	BENCH_COUNTER_MAX
+};
+
+struct bench_counters {
+	int fd[BENCH_COUNTER_MAX];
+	long long value[BENCH_COUNTER_MAX];
+};
+
+static inline unsigned long long bench_clock (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static int bench_counter_open (unsigned int type, unsigned long long config)
+{
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void bench_counters_init (struct bench_counters *counters)
+{
+	counters->fd[BENCH_COUNTER_DTLB] = bench_counter_open(PERF_TYPE_HW_CACHE,
+		PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+	counters->fd[BENCH_COUNTER_CACHE] = bench_counter_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+}
+
+static void bench_counters_fini (struct bench_counters *counters)
+{
+	int i;
+	for (i = 0; i < BENCH_COUNTER_MAX; i++) {
+		if (counters->fd[i] >= 0) {
+			close(counters->fd[i]);
+		}
+	}
+}
+
+static void bench_counters_start (struct bench_counters *counters)
+{
+	int i;
+	for (i = 0; i < BENCH_COUNTER_MAX; i++) {
+		counters->value[i] = -1;
+		if (counters->fd[i] >= 0) {
+			ioctl(counters->fd[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(counters->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+}
+
+static void bench_counters_stop (struct bench_counters *counters)
+{
+	int i;
+	for (i = 0; i < BENCH_COUNTER_MAX; i++) {
+		if (counters->fd[i] >= 0) {
+			ioctl(counters->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+			if (read(counters->fd[i], &counters->value[i], sizeof(long long)) != sizeof(long long)) {
+				counters->value[i] = -1;
+			}
+		}
+	}
+}
+
+static void bench_counters_print (const struct bench_counters *counters, unsigned long long ops)
+{
+	int i;
+	for (i = 0; i < BENCH_COUNTER_MAX; i++) {
+		if (counters->value[i] < 0) {
+			printf(",n/a");
+		} else {
+			printf(",%.3f", ((double) counters->value[i]) / ops);
+		}
+	}
+}
+
+static int bench_scan (unsigned long long *ns)
+{
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	unsigned long long t0;
+	struct hmemory_leaks leaks;
+	t0 = bench_clock();
+	if (hmemory_leaks(&leaks) != 0) {
+		return -1;
+	}
+	*ns = bench_clock() - t0;
+	return 0;
+#else
+	(void) ns;
+	return -1;
+#endif
+}
+
+static int bench_run (const char *metadata, unsigned long long blocks, size_t size)
+{
+	unsigned long long i;
+	unsigned long long j;
+	unsigned long long t0;
+	unsigned long long touch;
+	unsigned long long release;
+	unsigned long long scan;
+	unsigned long long sum;
+	unsigned long long seed;
+	void *tmp;
+	void **live;
+	struct bench_counters ctouch;
+	struct bench_counters crelease;
+	live = malloc(sizeof(void *) * blocks);
+	if (live == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		return -1;
+	}
+	for (i = 0; i < blocks; i++) {
+		live[i] = malloc(size);
+		if (live[i] == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			return -1;
+		}
+		memset(live[i], (int) i, size);
+	}
+	bench_counters_init(&ctouch);
+	bench_counters_init(&crelease);
+	/* program side, walk the blocks in allocation order */
+	bench_counters_start(&ctouch);
+	t0 = bench_clock();
+	for (sum = 0, i = 0; i < blocks; i++) {
+		sum += *(volatile unsigned char *) live[i];
+	}
+	touch = bench_clock() - t0;
+	bench_counters_stop(&ctouch);
+	if (bench_scan(&scan) != 0) {
+		scan = 0;
+	}
+	/* tracker side, free in random order so every lookup misses */
+	for (seed = 88172645463325252ULL, i = blocks - 1; i > 0; i--) {
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+		j = seed % (i + 1);
+		tmp = live[i];
+		live[i] = live[j];
+		live[j] = tmp;
+	}
+	bench_counters_start(&crelease);
+	t0 = bench_clock();
+	for (i = 0; i < blocks; i++) {
+		free(live[i]);
+	}
+	release = bench_clock() - t0;
+	bench_counters_stop(&crelease);
+	printf("%s,%s,%llu,%zu,%.1f", BENCH_BUILD, metadata, blocks, size, ((double) touch) / blocks);
+	bench_counters_print(&ctouch, blocks);
+	printf(",%.1f", ((double) release) / blocks);
+	bench_counters_print(&crelease, blocks);
+	if (scan == 0) {
+		printf(",n/a");
+	} else {
+		printf(",%.0f", ((double) blocks) * 1e9 / scan);
+	}
+	printf("\n");
+	fflush(stdout);
+	bench_counters_fini(&ctouch);
+	bench_counters_fini(&crelease);
+	free(live);
+	return (sum == 0xffffffffffffffffULL) ? -1 : 0;
+}
+
+static int bench_parse_list (const char *arg, unsigned long long *list)
+{
+	int n;
+	char *end;
+	for (n = 0; *arg != '\0' && n < BENCH_LIST_MAX; n++) {
+		list[n] = strtoull(arg, &end, 0);
+		if (*end == 'k' || *end == 'K') {
+			list[n] *= 1024;
+			end++;
+		} else if (*end == 'm' || *end == 'M') {
+			list[n] *= 1024 * 1024;
+			end++;
+		}
+		if (*end == ',') {
+			end++;
+		}
+		arg = end;
+	}
+	return n;
+}
+
+static void bench_usage (const char *name)
+{
+	fprintf(stderr, "usage: %s [options]\n", name);
+	fprintf(stderr, "  -b, --blocks     : comma separated live block counts (default: 100000,1000000,4000000)\n");
+	fprintf(stderr, "  -s, --size       : block size (default: 32)\n");
+	fprintf(stderr, "  -m, --metadata   : comma separated hmemory_metadata_region values, each run in a new process (default: 0,1)\n");
+	fprintf(stderr, "  -n, --no-header  : do not print csv header\n");
+	fprintf(stderr, "  -h, --help       : this text\n");
+}
+
+int main (int argc, char *argv[])
+{
+	int c;
+	int k;
+	int header;
+	int nblocks;
+	int nmetadata;
+	int status;
+	char value[32];
+	char **args;
+	size_t size;
+	pid_t pid;
+	const char *metadata;
+	unsigned long long blocks[BENCH_LIST_MAX] = { 100000, 1000000, 4000000 };
+	unsigned long long metadatas[BENCH_LIST_MAX] = { 0, 1 };
+	struct option options[] = {
+		{ "blocks", required_argument, NULL, 'b' },
+		{ "size", required_argument, NULL, 's' },
+		{ "metadata", required_argument, NULL, 'm' },
+		{ "no-header", no_argument, NULL, 'n' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	header = 1;
+	nblocks = 3;
+	nmetadata = 2;
+	size = 32;
+	while ((c = getopt_long(argc, argv, "b:s:m:nh", options, NULL)) != -1) {
+		switch (c) {
+			case 'b': nblocks = bench_parse_list(optarg, blocks); break;
+			case 's': size = strtoull(optarg, NULL, 0); break;
+			case 'm': nmetadata = bench_parse_list(optarg, metadatas); break;
+			case 'n': header = 0; break;
+			case 'h': bench_usage(argv[0]); return 0;
+			default: bench_usage(argv[0]); return -1;
+		}
+	}
+	if (header) {
+		printf("build,metadata,blocks,size,touch_ns,touch_dtlb_misses,touch_cache_misses,free_ns,free_dtlb_misses,free_cache_misses,scan_blocks_per_sec\n");
+		fflush(stdout);
+	}
+	metadata = getenv(BENCH_METADATA_NAME);
+	if (strcmp(BENCH_BUILD, "debug") != 0 || metadata != NULL) {
+		for (c = 0; c < nblocks; c++) {
+			if (bench_run((strcmp(BENCH_BUILD, "debug") == 0) ? metadata : "n/a", blocks[c], size) != 0) {
+				return -1;
+			}
+		}
+		return 0;
+	}
+	/* the region is chosen once at startup, so every value runs in a new process */
+	args = malloc(sizeof(char *) * (argc + 2));
+	if (args == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		return -1;
+	}
+	memcpy(args, argv, sizeof(char *) * argc);
+	args[argc] = "-n";
+	args[argc + 1] = NULL;
+	for (k = 0; k < nmetadata; k++) {
+		snprintf(value, sizeof(value), "%llu", metadatas[k]);
+		pid = fork();
+		if (pid < 0) {
+			fprintf(stderr, "fork failed\n");
+			return -1;
+		}
+		if (pid == 0) {
+			setenv(BENCH_METADATA_NAME, value, 1);
+			execv("/proc/self/exe", args);
+			_exit(127);
+		}
+		if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			fprintf(stderr, "run with %s=%s failed\n", BENCH_METADATA_NAME, value);
+			return -1;
+		}
+	}
+	free(args);
+	return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+
+#if !defined(BENCH_BUILD)
+#define BENCH_BUILD		"plain"
+#endif
+
+#define REALLOC_LIST_MAX	32
+
+enum {
+	REALLOC_GROWTH_EXACT,
+	REALLOC_GROWTH_DOUBLE,
+	REALLOC_GROWTH_MAX
+};
+
+static const char *realloc_growth_names[REALLOC_GROWTH_MAX] = {
+	"exact",
+	"double",
+};
+
+struct realloc_string {
+	char *buffer;
+	size_t length;
+	size_t capacity;
+};
+
+static inline unsigned long long realloc_clock (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static int realloc_append (struct realloc_string *s, int growth, const char *chunk, size_t size, unsigned long long *reallocs)
+{
+	char *b;
+	size_t capacity;
+	if (s->length + size + 1 > s->capacity) {
+		capacity = s->length + size + 1;
+		if (growth == REALLOC_GROWTH_DOUBLE && capacity < s->capacity * 2) {
+			capacity = s->capacity * 2;
+		}
+		b = realloc(s->buffer, capacity);
+		if (b == NULL) {
+			return -1;
+		}
+		s->buffer = b;
+		s->capacity = capacity;
+		*reallocs += 1;
+	}
+	memcpy(s->buffer + s->length, chunk, size);
+	s->length += size;
+	s->buffer[s->length] = '\0';
+	return 0;
+}
+
+/*
+ * string builders appending fixed size chunks until they reach the final
+ * length, several builders are interleaved so that blocks can not always
+ * grow in place. exact growth reallocs on every append, like naive
+ * concatenation, double growth reallocs geometrically.
+ */
+static int realloc_run (int growth, size_t chunk, size_t length, unsigned int strings)
+{
+	unsigned int i;
+	size_t n;
+	char *c;
+	unsigned long long t0;
+	unsigned long long t1;
+	unsigned long long reallocs;
+	struct realloc_string *s;
+	c = malloc(chunk);
+	s = calloc(strings, sizeof(struct realloc_string));
+	if (c == NULL || s == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		return -1;
+	}
+	memset(c, 'a', chunk);
+	reallocs = 0;
+	t0 = realloc_clock();
+	for (n = 0; n < length; n += chunk) {
+		for (i = 0; i < strings; i++) {
+			if (realloc_append(&s[i], growth, c, chunk, &reallocs) != 0) {
+				fprintf(stderr, "realloc failed\n");
+				return -1;
+			}
+		}
+	}
+	t1 = realloc_clock();
+	for (i = 0; i < strings; i++) {
+		free(s[i].buffer);
+	}
+	printf("%s,%s,%zu,%zu,%u,%llu,%.06f,%.1f\n",
+		BENCH_BUILD,
+		realloc_growth_names[growth],
+		chunk,
+		length,
+		strings,
+		reallocs,
+		((double) (t1 - t0)) / 1e9,
+		(reallocs == 0) ? 0.0 : ((double) (t1 - t0)) / reallocs);
+	fflush(stdout);
+	free(s);
+	free(c);
+	return 0;
+}
+
+static int realloc_parse_list (const char *arg, unsigned long long *list)
+{
+	int n;
+	char *end;
+	for (n = 0; *arg != '\0' && n < REALLOC_LIST_MAX; n++) {
+		list[n] = strtoull(arg, &end, 0);
+		if (*end == 'k' || *end == 'K') {
+			list[n] *= 1024;
+			end++;
+		} else if (*end == 'm' || *end == 'M') {
+			list[n] *= 1024 * 1024;
+			end++;
+		}
+		if (*end == ',') {
+			end++;
+		}
+		arg = end;
+	}
+	return n;
+}
+
+static void realloc_usage (const char *name)
+{
+	fprintf(stderr, "usage: %s [options]\n", name);
+	fprintf(stderr, "  -c, --chunks    : comma separated append sizes (default: 1,16,256)\n");
+	fprintf(stderr, "  -l, --lengths   : comma separated final string lengths (default: 4k,64k,1m)\n");
+	fprintf(stderr, "  -s, --strings   : strings built at the same time (default: 16)\n");
+	fprintf(stderr, "  -n, --no-header : do not print csv header\n");
+	fprintf(stderr, "  -h, --help      : this text\n");
+}
+
+int main (int argc, char *argv[])
+{
+	int c;
+	int l;
+	int g;
+	int header;
+	int nchunks;
+	int nlengths;
+	unsigned int strings;
+	unsigned long long chunks[REALLOC_LIST_MAX] = { 1, 16, 256 };
+	unsigned long long lengths[REALLOC_LIST_MAX] = { 4096, 65536, 1048576 };
+	struct option options[] = {
+		{ "chunks", required_argument, NULL, 'c' },
+		{ "lengths", required_argument, NULL, 'l' },
+		{ "strings", required_argument, NULL, 's' },
+		{ "no-header", no_argument, NULL, 'n' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	header = 1;
+	nchunks = 3;
+	nlengths = 3;
+	strings = 16;
+	while ((c = getopt_long(argc, argv, "c:l:s:nh", options, NULL)) != -1) {
+		switch (c) {
+			case 'c': nchunks = realloc_parse_list(optarg, chunks); break;
+			case 'l': nlengths = realloc_parse_list(optarg, lengths); break;
+			case 's': strings = strtoul(optarg, NULL, 0); break;
+			case 'n': header = 0; break;
+			case 'h': realloc_usage(argv[0]); return 0;
+			default: realloc_usage(argv[0]); return -1;
+		}
+	}
+	if (strings == 0) {
+		strings = 1;
+	}
+	if (header) {
+		printf("build,growth,chunk,length,strings,reallocs,seconds,ns_per_realloc\n");
+	}
+	for (g = 0; g < REALLOC_GROWTH_MAX; g++) {
+		for (c = 0; c < nchunks; c++) {
+			for (l = 0; l < nlengths; l++) {
+				if (chunks[c] == 0) {
+					continue;
+				}
+				if (realloc_run(g, chunks[c], lengths[l], strings) != 0) {
+					return -1;
+				}
+			}
+		}
+	}
+	return 0;
+}
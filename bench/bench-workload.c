@@ -0,0 +1,609 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+
+#if !defined(BENCH_BUILD)
+#define BENCH_BUILD		"plain"
+#endif
+
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+#define WORKLOAD_VERIFY		1
+#else
+#define WORKLOAD_VERIFY		0
+#endif
+
+#define WORKLOAD_LIST_MAX	32
+#define WORKLOAD_QUEUE_SIZE	4096
+
+enum {
+	WORKLOAD_CHURN,
+	WORKLOAD_PRODUCER,
+	WORKLOAD_REALLOC,
+	WORKLOAD_STRING,
+	WORKLOAD_TREE,
+	WORKLOAD_MIXED,
+	WORKLOAD_MAX
+};
+
+static const char *workload_names[WORKLOAD_MAX] = {
+	"churn",
+	"producer",
+	"realloc",
+	"string",
+	"tree",
+	"mixed",
+};
+
+static const char workload_text[] =
+	"{\"id\": 1, \"name\": \"alpha\", \"tags\": [\"a\", \"b\"]}\n"
+	"2014-01-01 00:00:00 info worker started\n"
+	"short\n"
+	"a somewhat longer line of text that forces getline to grow its buffer past the initial size "
+	"and keep going for a while so that we get a few reallocations on the way\n"
+	"\n"
+	"key=value;key2=value2;key3=value3\n";
+
+struct workload_block {
+	void *address;
+	size_t size;
+};
+
+struct workload_node {
+	char *key;
+	char *value;
+	struct workload_node **children;
+	size_t nchildren;
+	size_t size;
+};
+
+struct workload_queue {
+	pthread_mutex_t mutex;
+	struct workload_block *blocks;
+	unsigned int head;
+	unsigned int count;
+};
+
+struct workload {
+	int scenario;
+	unsigned int threads;
+	unsigned long long operations;
+	unsigned long long interval;
+	unsigned int live;
+	size_t min;
+	size_t max;
+	struct workload_queue queue;
+	pthread_barrier_t barrier;
+	struct workload_thread *thread;
+	unsigned long long baseline_bytes;
+	unsigned long long baseline_blocks;
+	unsigned long long checks;
+	int errors;
+};
+
+struct workload_thread {
+	pthread_t thread;
+	unsigned int id;
+	unsigned long long seed;
+	long long bytes;
+	long long blocks;
+	struct workload_block *slots;
+	FILE *stream;
+	struct workload *workload;
+};
+
+static inline unsigned long long workload_clock (void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline unsigned long long workload_random (struct workload_thread *t)
+{
+	t->seed ^= t->seed << 13;
+	t->seed ^= t->seed >> 7;
+	t->seed ^= t->seed << 17;
+	return t->seed;
+}
+
+static inline size_t workload_size (struct workload_thread *t)
+{
+	unsigned int lmin;
+	unsigned int lmax;
+	unsigned int l;
+	size_t s;
+	lmin = 63 - __builtin_clzll(t->workload->min);
+	lmax = 63 - __builtin_clzll(t->workload->max);
+	l = lmin + workload_random(t) % (lmax - lmin + 1);
+	s = (1ULL << l) + workload_random(t) % (1ULL << l);
+	if (s < t->workload->min) {
+		s = t->workload->min;
+	}
+	if (s > t->workload->max) {
+		s = t->workload->max;
+	}
+	return s;
+}
+
+static void workload_account (struct workload_thread *t, long long bytes, long long blocks)
+{
+	t->bytes += bytes;
+	t->blocks += blocks;
+}
+
+static void workload_churn (struct workload_thread *t)
+{
+	unsigned int i;
+	struct workload_block *b;
+	i = workload_random(t) % t->workload->live;
+	b = &t->slots[i];
+	if (b->address != NULL) {
+		free(b->address);
+		workload_account(t, -(long long) b->size, -1);
+		b->address = NULL;
+	}
+	b->size = workload_size(t);
+	if (workload_random(t) & 1) {
+		b->address = malloc(b->size);
+	} else {
+		b->address = calloc(1, b->size);
+	}
+	if (b->address == NULL) {
+		fprintf(stderr, "allocation failed\n");
+		exit(-1);
+	}
+	memset(b->address, 0x5a, b->size);
+	workload_account(t, b->size, 1);
+}
+
+static void workload_producer (struct workload_thread *t)
+{
+	int produce;
+	struct workload_block b;
+	struct workload_queue *q;
+	q = &t->workload->queue;
+	if (t->workload->threads == 1) {
+		produce = workload_random(t) & 1;
+	} else {
+		produce = (t->id & 1) == 0;
+	}
+	if (produce) {
+		b.size = workload_size(t);
+		b.address = malloc(b.size);
+		if (b.address == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			exit(-1);
+		}
+		memset(b.address, 0xa5, b.size);
+		workload_account(t, b.size, 1);
+		pthread_mutex_lock(&q->mutex);
+		if (q->count < WORKLOAD_QUEUE_SIZE) {
+			q->blocks[(q->head + q->count) % WORKLOAD_QUEUE_SIZE] = b;
+			q->count += 1;
+			b.address = NULL;
+		}
+		pthread_mutex_unlock(&q->mutex);
+		if (b.address != NULL) {
+			free(b.address);
+			workload_account(t, -(long long) b.size, -1);
+		}
+	} else {
+		b.address = NULL;
+		pthread_mutex_lock(&q->mutex);
+		if (q->count > 0) {
+			b = q->blocks[q->head];
+			q->head = (q->head + 1) % WORKLOAD_QUEUE_SIZE;
+			q->count -= 1;
+		}
+		pthread_mutex_unlock(&q->mutex);
+		if (b.address != NULL) {
+			free(b.address);
+			workload_account(t, -(long long) b.size, -1);
+		}
+	}
+}
+
+static void workload_realloc (struct workload_thread *t)
+{
+	void *p;
+	size_t s;
+	size_t n;
+	size_t max;
+	p = NULL;
+	s = 0;
+	max = workload_size(t) * 4;
+	for (n = t->workload->min; n <= max; n = n * 3 / 2 + 1) {
+		p = realloc(p, n);
+		if (p == NULL) {
+			fprintf(stderr, "realloc failed\n");
+			exit(-1);
+		}
+		memset(p + s, 0x3c, n - s);
+		workload_account(t, (long long) n - (long long) s, (s == 0) ? 1 : 0);
+		s = n;
+	}
+	free(p);
+	workload_account(t, -(long long) s, -1);
+}
+
+static void workload_string (struct workload_thread *t)
+{
+	int rc;
+	char *a;
+	char *d;
+	char *n;
+	char *line;
+	size_t size;
+	long long bytes;
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "string-%llu", workload_random(t) % 100000);
+	d = strdup(buffer);
+	n = strndup(workload_text, workload_random(t) % 64);
+	rc = asprintf(&a, "%s:%u:%s", d, t->id, n);
+	if (d == NULL || n == NULL || rc < 0) {
+		fprintf(stderr, "string allocation failed\n");
+		exit(-1);
+	}
+	bytes = strlen(d) + 1 + strlen(n) + 1 + rc + 1;
+	workload_account(t, bytes, 3);
+	line = NULL;
+	size = 0;
+	if (getline(&line, &size, t->stream) < 0) {
+		rewind(t->stream);
+	}
+	free(line);
+	free(a);
+	free(n);
+	free(d);
+	workload_account(t, -bytes, -3);
+}
+
+static struct workload_node * workload_tree_build (struct workload_thread *t, unsigned int depth, unsigned int *budget)
+{
+	unsigned int i;
+	unsigned int n;
+	char buffer[32];
+	struct workload_node *node;
+	node = calloc(1, sizeof(struct workload_node));
+	if (node == NULL) {
+		fprintf(stderr, "calloc failed\n");
+		exit(-1);
+	}
+	workload_account(t, sizeof(struct workload_node), 1);
+	snprintf(buffer, sizeof(buffer), "key%llu", workload_random(t) % 1000);
+	node->key = strdup(buffer);
+	snprintf(buffer, sizeof(buffer), "value%llu", workload_random(t));
+	node->value = strdup(buffer);
+	workload_account(t, strlen(node->key) + 1 + strlen(node->value) + 1, 2);
+	*budget -= 1;
+	if (depth == 0) {
+		return node;
+	}
+	n = workload_random(t) % 8;
+	for (i = 0; i < n && *budget > 0; i++) {
+		if (node->nchildren == node->size) {
+			size_t s;
+			s = (node->size == 0) ? 2 : node->size * 2;
+			node->children = realloc(node->children, sizeof(struct workload_node *) * s);
+			if (node->children == NULL) {
+				fprintf(stderr, "realloc failed\n");
+				exit(-1);
+			}
+			workload_account(t, (long long) (sizeof(struct workload_node *) * (s - node->size)), (node->size == 0) ? 1 : 0);
+			node->size = s;
+		}
+		node->children[node->nchildren++] = workload_tree_build(t, depth - 1, budget);
+	}
+	return node;
+}
+
+static void workload_tree_destroy (struct workload_thread *t, struct workload_node *node)
+{
+	size_t i;
+	for (i = 0; i < node->nchildren; i++) {
+		workload_tree_destroy(t, node->children[i]);
+	}
+	if (node->children != NULL) {
+		workload_account(t, -(long long) (sizeof(struct workload_node *) * node->size), -1);
+	}
+	workload_account(t, -(long long) (strlen(node->key) + 1 + strlen(node->value) + 1 + sizeof(struct workload_node)), -3);
+	free(node->children);
+	free(node->key);
+	free(node->value);
+	free(node);
+}
+
+static void workload_tree (struct workload_thread *t)
+{
+	unsigned int budget;
+	struct workload_node *root;
+	budget = 16 + workload_random(t) % 112;
+	root = workload_tree_build(t, 6, &budget);
+	workload_tree_destroy(t, root);
+}
+
+static int workload_verify (struct workload *w, const char *stage)
+{
+#if WORKLOAD_VERIFY
+	unsigned int i;
+	long long bytes;
+	long long blocks;
+	struct hmemory_information information;
+	bytes = 0;
+	blocks = 0;
+	for (i = 0; i < w->threads; i++) {
+		bytes += w->thread[i].bytes;
+		blocks += w->thread[i].blocks;
+	}
+	hmemory_information(&information);
+	w->checks += 1;
+	if ((long long) (information.current - w->baseline_bytes) != bytes ||
+	    (long long) (information.blocks - w->baseline_blocks) != blocks) {
+		fprintf(stderr, "%s: %s: tracker mismatch, expected %lld bytes in %lld blocks, tracked %lld bytes in %lld blocks\n",
+			workload_names[w->scenario], stage,
+			bytes, blocks,
+			(long long) (information.current - w->baseline_bytes),
+			(long long) (information.blocks - w->baseline_blocks));
+		w->errors += 1;
+		return -1;
+	}
+#else
+	(void) w;
+	(void) stage;
+#endif
+	return 0;
+}
+
+static void * workload_worker (void *arg)
+{
+	int s;
+	unsigned long long n;
+	struct workload *w;
+	struct workload_thread *t;
+	t = arg;
+	w = t->workload;
+	pthread_barrier_wait(&w->barrier);
+	for (n = 1; n <= w->operations; n++) {
+		s = w->scenario;
+		if (s == WORKLOAD_MIXED) {
+			s = workload_random(t) % WORKLOAD_MIXED;
+		}
+		switch (s) {
+			case WORKLOAD_CHURN:    workload_churn(t);    break;
+			case WORKLOAD_PRODUCER: workload_producer(t); break;
+			case WORKLOAD_REALLOC:  workload_realloc(t);  break;
+			case WORKLOAD_STRING:   workload_string(t);   break;
+			case WORKLOAD_TREE:     workload_tree(t);     break;
+		}
+		if (w->interval != 0 && (n % w->interval) == 0) {
+			if (pthread_barrier_wait(&w->barrier) == PTHREAD_BARRIER_SERIAL_THREAD) {
+				workload_verify(w, "checkpoint");
+			}
+			pthread_barrier_wait(&w->barrier);
+		}
+	}
+	return NULL;
+}
+
+static int workload_run (struct workload *w)
+{
+	unsigned int i;
+	unsigned int j;
+	unsigned long long wall;
+#if WORKLOAD_VERIFY
+	struct hmemory_information information;
+#endif
+	w->checks = 0;
+	w->errors = 0;
+	w->thread = calloc(w->threads, sizeof(struct workload_thread));
+	w->queue.blocks = calloc(WORKLOAD_QUEUE_SIZE, sizeof(struct workload_block));
+	if (w->thread == NULL || w->queue.blocks == NULL) {
+		fprintf(stderr, "calloc failed\n");
+		return -1;
+	}
+	w->queue.head = 0;
+	w->queue.count = 0;
+	pthread_mutex_init(&w->queue.mutex, NULL);
+	pthread_barrier_init(&w->barrier, NULL, w->threads + 1);
+	for (i = 0; i < w->threads; i++) {
+		w->thread[i].id = i;
+		w->thread[i].seed = 0x9e3779b97f4a7c15ULL * (i + 1);
+		w->thread[i].workload = w;
+		w->thread[i].slots = calloc(w->live, sizeof(struct workload_block));
+		w->thread[i].stream = fmemopen((void *) workload_text, sizeof(workload_text) - 1, "r");
+		if (w->thread[i].slots == NULL || w->thread[i].stream == NULL) {
+			fprintf(stderr, "can not create thread context\n");
+			return -1;
+		}
+	}
+#if WORKLOAD_VERIFY
+	hmemory_information(&information);
+	w->baseline_bytes = information.current;
+	w->baseline_blocks = information.blocks;
+#endif
+	pthread_barrier_destroy(&w->barrier);
+	pthread_barrier_init(&w->barrier, NULL, w->threads);
+	for (i = 0; i < w->threads; i++) {
+		if (pthread_create(&w->thread[i].thread, NULL, workload_worker, &w->thread[i]) != 0) {
+			fprintf(stderr, "pthread_create failed\n");
+			return -1;
+		}
+	}
+	wall = workload_clock();
+	for (i = 0; i < w->threads; i++) {
+		pthread_join(w->thread[i].thread, NULL);
+	}
+	wall = workload_clock() - wall;
+	workload_verify(w, "finish");
+	for (i = 0; i < w->threads; i++) {
+		for (j = 0; j < w->live; j++) {
+			if (w->thread[i].slots[j].address != NULL) {
+				free(w->thread[i].slots[j].address);
+				workload_account(&w->thread[i], -(long long) w->thread[i].slots[j].size, -1);
+			}
+		}
+	}
+	while (w->queue.count > 0) {
+		free(w->queue.blocks[w->queue.head].address);
+		workload_account(&w->thread[0], -(long long) w->queue.blocks[w->queue.head].size, -1);
+		w->queue.head = (w->queue.head + 1) % WORKLOAD_QUEUE_SIZE;
+		w->queue.count -= 1;
+	}
+	workload_verify(w, "teardown");
+	printf("%s,%s,%u,%llu,%.06f,%.0f,%llu,%s\n",
+		BENCH_BUILD,
+		workload_names[w->scenario],
+		w->threads,
+		w->operations * w->threads,
+		((double) wall) / 1e9,
+		((double) w->operations * w->threads) * 1e9 / wall,
+		w->checks,
+		(WORKLOAD_VERIFY == 0) ? "n/a" : (w->errors == 0) ? "ok" : "mismatch");
+	fflush(stdout);
+	for (i = 0; i < w->threads; i++) {
+		fclose(w->thread[i].stream);
+		free(w->thread[i].slots);
+	}
+	pthread_barrier_destroy(&w->barrier);
+	pthread_mutex_destroy(&w->queue.mutex);
+	free(w->queue.blocks);
+	free(w->thread);
+	return w->errors;
+}
+
+static int workload_parse_list (const char *arg, unsigned long long *list)
+{
+	int n;
+	char *end;
+	for (n = 0; *arg != '\0' && n < WORKLOAD_LIST_MAX; n++) {
+		list[n] = strtoull(arg, &end, 0);
+		if (*end == ',') {
+			end++;
+		}
+		arg = end;
+	}
+	return n;
+}
+
+static void workload_usage (const char *name)
+{
+	fprintf(stderr, "usage: %s [options]\n", name);
+	fprintf(stderr, "  -w, --workload   : churn, producer, realloc, string, tree, mixed or all (default: all)\n");
+	fprintf(stderr, "  -t, --threads    : comma separated thread counts (default: 1,2,4,..,nproc)\n");
+	fprintf(stderr, "  -o, --operations : operations per thread (default: 20000)\n");
+	fprintf(stderr, "  -c, --check      : verify tracker every n operations per thread, 0 to disable (default: 5000)\n");
+	fprintf(stderr, "  -l, --live       : live block slots per thread for churn (default: 4096)\n");
+	fprintf(stderr, "  -s, --sizes      : min:max block size, log uniform (default: 8:65536)\n");
+	fprintf(stderr, "  -n, --no-header  : do not print csv header\n");
+	fprintf(stderr, "  -h, --help       : this text\n");
+}
+
+int main (int argc, char *argv[])
+{
+	int c;
+	int k;
+	int first;
+	int last;
+	int nthreads;
+	int errors;
+	int header;
+	long cpus;
+	unsigned long long l;
+	unsigned long long threads[WORKLOAD_LIST_MAX];
+	struct workload w;
+	struct option options[] = {
+		{ "workload", required_argument, NULL, 'w' },
+		{ "threads", required_argument, NULL, 't' },
+		{ "operations", required_argument, NULL, 'o' },
+		{ "check", required_argument, NULL, 'c' },
+		{ "live", required_argument, NULL, 'l' },
+		{ "sizes", required_argument, NULL, 's' },
+		{ "no-header", no_argument, NULL, 'n' },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 },
+	};
+	memset(&w, 0, sizeof(w));
+	w.operations = 20000;
+	w.interval = 5000;
+	w.live = 4096;
+	w.min = 8;
+	w.max = 65536;
+	first = 0;
+	last = WORKLOAD_MAX - 1;
+	header = 1;
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	for (nthreads = 0, l = 1; l <= (unsigned long long) ((cpus < 1) ? 1 : cpus); l *= 2) {
+		threads[nthreads++] = l;
+	}
+	if (threads[nthreads - 1] != (unsigned long long) cpus && cpus > 1) {
+		threads[nthreads++] = cpus;
+	}
+	if (threads[nthreads - 1] < 2) {
+		threads[nthreads++] = 2;
+	}
+	while ((c = getopt_long(argc, argv, "w:t:o:c:l:s:nh", options, NULL)) != -1) {
+		switch (c) {
+			case 'w':
+				if (strcmp(optarg, "all") == 0) {
+					first = 0;
+					last = WORKLOAD_MAX - 1;
+					break;
+				}
+				for (k = 0; k < WORKLOAD_MAX; k++) {
+					if (strcmp(optarg, workload_names[k]) == 0) {
+						break;
+					}
+				}
+				if (k == WORKLOAD_MAX) {
+					workload_usage(argv[0]);
+					return -1;
+				}
+				first = k;
+				last = k;
+				break;
+			case 't': nthreads = workload_parse_list(optarg, threads); break;
+			case 'o': w.operations = strtoull(optarg, NULL, 0); break;
+			case 'c': w.interval = strtoull(optarg, NULL, 0); break;
+			case 'l': w.live = strtoul(optarg, NULL, 0); break;
+			case 's':
+				w.min = strtoul(optarg, &optarg, 0);
+				w.max = (*optarg == ':') ? strtoul(optarg + 1, NULL, 0) : w.min;
+				break;
+			case 'n': header = 0; break;
+			case 'h': workload_usage(argv[0]); return 0;
+			default: workload_usage(argv[0]); return -1;
+		}
+	}
+	if (w.live == 0 || w.min == 0 || w.max < w.min) {
+		workload_usage(argv[0]);
+		return -1;
+	}
+	if (header) {
+		printf("build,workload,threads,ops,seconds,ops_per_sec,checks,verified\n");
+	}
+	errors = 0;
+	for (k = first; k <= last; k++) {
+		for (c = 0; c < nthreads; c++) {
+			w.scenario = k;
+			w.threads = threads[c];
+			if (workload_run(&w) != 0) {
+				errors += 1;
+			}
+		}
+	}
+	return (errors == 0) ? 0 : -1;
+}
@@ -0,0 +1,470 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#if !defined(HMEMORY_H)
+#define HMEMORY_H 1
+
+#if !defined(HMEMORY_DISABLE_YIELD)
+#define HMEMORY_DISABLE_YIELD			0
+#endif
+
+#if !defined(HMEMORY_ENABLE_CALLSTACK)
+#define HMEMORY_ENABLE_CALLSTACK		1
+#endif
+
+#if defined(__DARWIN__) && (__DARWIN__ == 1)
+#undef HMEMORY_ENABLE_CALLSTACK
+#define HMEMORY_ENABLE_CALLSTACK		0
+#endif
+
+#if !defined(HMEMORY_ENABLE_PROFILE)
+#define HMEMORY_ENABLE_PROFILE			0
+#endif
+
+#if !defined(HMEMORY_ARENA_RECORDS)
+#define HMEMORY_ARENA_RECORDS			0
+#endif
+
+#if !defined(HMEMORY_ARENA_SITES)
+#define HMEMORY_ARENA_SITES			64
+#endif
+
+#if !defined(HMEMORY_ARENA_NAME_MAX)
+#define HMEMORY_ARENA_NAME_MAX			64
+#endif
+
+#if !defined(HMEMORY_REPORT_CALLSTACK)
+#define HMEMORY_REPORT_CALLSTACK		1
+#endif
+#define HMEMORY_REPORT_CALLSTACK_NAME		"hmemory_report_callstack"
+
+#if !defined(HMEMORY_ASSERT_ON_ERROR)
+#define HMEMORY_ASSERT_ON_ERROR			1
+#endif
+#define HMEMORY_ASSERT_ON_ERROR_NAME		"hmemory_assert_on_error"
+
+#if !defined(HMEMORY_CHECK_INTERVAL)
+#define HMEMORY_CHECK_INTERVAL			5000
+#endif
+#define HMEMORY_CHECK_INTERVAL_NAME		"hmemory_check_interval"
+
+#if !defined(HMEMORY_SHOW_REACHABLE)
+#define HMEMORY_SHOW_REACHABLE			0
+#endif
+#define HMEMORY_SHOW_REACHABLE_NAME		"hmemory_show_reachable"
+
+#if !defined(HMEMORY_STATISTICS_BATCH)
+#define HMEMORY_STATISTICS_BATCH		(64 * 1024)
+#endif
+
+#if !defined(HMEMORY_REPORT_HISTOGRAM)
+#define HMEMORY_REPORT_HISTOGRAM		1
+#endif
+#define HMEMORY_REPORT_HISTOGRAM_NAME		"hmemory_report_histogram"
+
+#define HMEMORY_HISTOGRAM_FILE_NAME		"hmemory_histogram_file"
+
+#if !defined(HMEMORY_SITE_MAX)
+#define HMEMORY_SITE_MAX			4096
+#endif
+
+#if !defined(HMEMORY_REPORT_COPY)
+#define HMEMORY_REPORT_COPY			10
+#endif
+#define HMEMORY_REPORT_COPY_NAME		"hmemory_report_copy"
+#define HMEMORY_COPY_TOP_MAX			64
+
+#if !defined(HMEMORY_LEAK_CHECK)
+#define HMEMORY_LEAK_CHECK			1
+#endif
+#define HMEMORY_LEAK_CHECK_NAME			"hmemory_leak_check"
+
+#if !defined(HMEMORY_LEAK_THREADS)
+#define HMEMORY_LEAK_THREADS			0
+#endif
+#define HMEMORY_LEAK_THREADS_NAME		"hmemory_leak_threads"
+
+#if !defined(HMEMORY_LEAK_TOP)
+#define HMEMORY_LEAK_TOP			20
+#endif
+#define HMEMORY_LEAK_TOP_NAME			"hmemory_leak_top"
+
+#if !defined(HMEMORY_FAST_EXIT)
+#define HMEMORY_FAST_EXIT			0
+#endif
+#define HMEMORY_FAST_EXIT_NAME			"hmemory_fast_exit"
+
+#define HMEMORY_SUPPRESSIONS_NAME		"hmemory_suppressions"
+
+#define HMEMORY_CONFIG_FILE_NAME		"hmemory_config_file"
+
+#if !defined(HMEMORY_LEAK_INTERVAL)
+#define HMEMORY_LEAK_INTERVAL			0
+#endif
+#define HMEMORY_LEAK_INTERVAL_NAME		"hmemory_leak_interval"
+
+#if !defined(HMEMORY_LEAK_SIGNAL)
+#define HMEMORY_LEAK_SIGNAL			0
+#endif
+#define HMEMORY_LEAK_SIGNAL_NAME		"hmemory_leak_signal"
+
+#if !defined(HMEMORY_FORK_STATISTICS)
+#define HMEMORY_FORK_STATISTICS			1
+#endif
+#define HMEMORY_FORK_STATISTICS_NAME		"hmemory_fork_statistics"
+
+#if !defined(HMEMORY_LARGE_THRESHOLD)
+#define HMEMORY_LARGE_THRESHOLD			1048576
+#endif
+#define HMEMORY_LARGE_THRESHOLD_NAME		"hmemory_large_threshold"
+
+#if !defined(HMEMORY_TABLE_CAPACITY)
+#define HMEMORY_TABLE_CAPACITY			0
+#endif
+#define HMEMORY_TABLE_CAPACITY_NAME		"hmemory_table_capacity"
+
+#if !defined(HMEMORY_METADATA_REGION)
+#define HMEMORY_METADATA_REGION			1
+#endif
+#define HMEMORY_METADATA_REGION_NAME		"hmemory_metadata_region"
+
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+
+#if !defined(HMEMORY_INTERNAL) || (HMEMORY_INTERNAL == 0)
+
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#define RAPIDJSON_MALLOC(size)			malloc(size)
+#define RAPIDJSON_FREE(ptr)			free(ptr)
+#define RAPIDJSON_REALLOC(ptr, new_size)	realloc(ptr, new_size)
+
+#define HMEMORY_DEBUG_NAME_MAX			256
+
+#undef memcpy
+#define memcpy(s1, s2, n) ({ \
+	void *__hmemory_r; \
+	__hmemory_r = hmemory_memcpy((s1), (s2), (n)); \
+	__hmemory_r; \
+})
+
+#ifndef __cplusplus
+
+#undef memmove
+#define memmove(s1, s2, n) ({ \
+	void *__hmemory_r; \
+	__hmemory_r = hmemory_memmove((s1), (s2), (n)); \
+	__hmemory_r; \
+})
+
+#undef memset
+#define memset(s, c, n) ({ \
+	void *__hmemory_r; \
+	__hmemory_r = hmemory_memset((s), (c), (n)); \
+	__hmemory_r; \
+})
+
+#undef strcpy
+#define strcpy(s1, s2) ({ \
+	char *__hmemory_r; \
+	__hmemory_r = hmemory_strcpy((s1), (s2)); \
+	__hmemory_r; \
+})
+
+#undef strncpy
+#define strncpy(s1, s2, n) ({ \
+	char *__hmemory_r; \
+	__hmemory_r = hmemory_strncpy((s1), (s2), (n)); \
+	__hmemory_r; \
+})
+
+#undef strcat
+#define strcat(s1, s2) ({ \
+	char *__hmemory_r; \
+	__hmemory_r = hmemory_strcat((s1), (s2)); \
+	__hmemory_r; \
+})
+
+#undef snprintf
+#define snprintf(s, n, fmt...) ({ \
+	int __hmemory_r; \
+	__hmemory_r = hmemory_snprintf((s), (n), fmt); \
+	__hmemory_r; \
+})
+
+#undef getline
+#define getline(strp, n, stream) ({ \
+	ssize_t __hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "getline(%s %s:%d)", __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_getline(__hmemory_n, strp, n, stream); \
+	__hmemory_r; \
+})
+
+#undef getdelim
+#define getdelim(strp, n, delim, stream) ({ \
+	ssize_t __hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "getdelim(%s %s:%d)", __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_getdelim(__hmemory_n, strp, n, delim, stream); \
+	__hmemory_r; \
+})
+
+#endif
+
+#undef asprintf
+#define asprintf(strp, fmt...) ({ \
+	int __hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "asprintf(%s %s:%d)", __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_asprintf(__hmemory_n, strp, fmt); \
+	__hmemory_r; \
+})
+
+#undef vasprintf
+#define vasprintf(strp, fmt, ap) ({ \
+	int __hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "vasprintf(%s %s:%d)", __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_vasprintf(__hmemory_n, strp, fmt, ap); \
+	__hmemory_r; \
+})
+
+#undef strdup
+#define strdup(string) ({ \
+	char *__hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "strdup-%p(%s %s:%d)", string, __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_strdup(__hmemory_n, string); \
+	__hmemory_r; \
+})
+
+#undef strndup
+#define strndup(string, size) ({ \
+	char *__hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "strndup-%p-%lld(%s %s:%d)", string, (long long) size, __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_strndup(__hmemory_n, string, size); \
+	__hmemory_r; \
+})
+
+#undef malloc
+#define malloc(size) ({ \
+	void *__hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "malloc-%lld(%s %s:%d)", (long long) (size), __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_malloc((__hmemory_n), (size)); \
+	__hmemory_r; \
+})
+
+#undef calloc
+#define calloc(nmemb, size) ({ \
+	void *__hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "calloc-%lld,%lld(%s %s:%d)", (long long) nmemb, (long long) (size), __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_calloc(__hmemory_n, nmemb, size); \
+	__hmemory_r; \
+})
+
+#undef realloc
+#define realloc(address, size) ({ \
+	void *__hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "realloc-%p,%lld(%s %s:%d)", address, (long long) (size), __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_realloc(__hmemory_n, address, size); \
+	__hmemory_r; \
+})
+
+#undef free
+#define free(address) ({ \
+	hmemory_free(address); \
+})
+
+#undef reallocarray
+#define reallocarray(address, nmemb, size) ({ \
+	void *__hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "reallocarray-%p,%lld,%lld(%s %s:%d)", address, (long long) (nmemb), (long long) (size), __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_reallocarray(__hmemory_n, address, nmemb, size); \
+	__hmemory_r; \
+})
+
+#undef posix_memalign
+#define posix_memalign(memptr, alignment, size) ({ \
+	int __hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "posix_memalign-%lld,%lld(%s %s:%d)", (long long) (alignment), (long long) (size), __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_posix_memalign(__hmemory_n, memptr, alignment, size); \
+	__hmemory_r; \
+})
+
+#undef aligned_alloc
+#define aligned_alloc(alignment, size) ({ \
+	void *__hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "aligned_alloc-%lld,%lld(%s %s:%d)", (long long) (alignment), (long long) (size), __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_aligned_alloc(__hmemory_n, alignment, size); \
+	__hmemory_r; \
+})
+
+#undef memalign
+#define memalign(alignment, size) ({ \
+	void *__hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "memalign-%lld,%lld(%s %s:%d)", (long long) (alignment), (long long) (size), __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_memalign(__hmemory_n, alignment, size); \
+	__hmemory_r; \
+})
+
+#undef valloc
+#define valloc(size) ({ \
+	void *__hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "valloc-%lld(%s %s:%d)", (long long) (size), __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_valloc(__hmemory_n, size); \
+	__hmemory_r; \
+})
+
+#undef pvalloc
+#define pvalloc(size) ({ \
+	void *__hmemory_r; \
+	char __hmemory_n[HMEMORY_DEBUG_NAME_MAX]; \
+	(snprintf)(__hmemory_n, HMEMORY_DEBUG_NAME_MAX, "pvalloc-%lld(%s %s:%d)", (long long) (size), __FUNCTION__, __FILE__, __LINE__); \
+	__hmemory_r = hmemory_pvalloc(__hmemory_n, size); \
+	__hmemory_r; \
+})
+
+#undef malloc_usable_size
+#define malloc_usable_size(address) ({ \
+	hmemory_malloc_usable_size(address); \
+})
+
+#endif
+
+#define HMEMORY_FUNCTION_NAME(function) hmemory_ ## function ## _debug
+
+#else
+
+#define HMEMORY_FUNCTION_NAME(function) hmemory_ ## function
+
+#endif
+
+#define hmemory_memcpy(a, b, c)               HMEMORY_FUNCTION_NAME(memcpy_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+#define hmemory_memmove(a, b, c)              HMEMORY_FUNCTION_NAME(memmove_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+#define hmemory_memset(a, b, c)               HMEMORY_FUNCTION_NAME(memset_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+#define hmemory_strcpy(a, b)                  HMEMORY_FUNCTION_NAME(strcpy_actual)(__FUNCTION__, __FILE__, __LINE__, a, b)
+#define hmemory_strncpy(a, b, c)              HMEMORY_FUNCTION_NAME(strncpy_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+#define hmemory_strcat(a, b)                  HMEMORY_FUNCTION_NAME(strcat_actual)(__FUNCTION__, __FILE__, __LINE__, a, b)
+#define hmemory_snprintf(a, b, c...)          HMEMORY_FUNCTION_NAME(snprintf_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+
+#define hmemory_getline(a, b, c, d)           HMEMORY_FUNCTION_NAME(getline_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c, d)
+#define hmemory_getdelim(a, b, c, d, e)       HMEMORY_FUNCTION_NAME(getdelim_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c, d, e)
+
+#define hmemory_asprintf(a, b...)             HMEMORY_FUNCTION_NAME(asprintf_actual)(__FUNCTION__, __FILE__, __LINE__, a, b)
+#define hmemory_vasprintf(a, b, c, d)         HMEMORY_FUNCTION_NAME(vasprintf_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c, d)
+
+#define hmemory_strdup(a, b)                  HMEMORY_FUNCTION_NAME(strdup_actual)(__FUNCTION__, __FILE__, __LINE__, a, b)
+#define hmemory_strndup(a, b, c)              HMEMORY_FUNCTION_NAME(strndup_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+
+#define hmemory_malloc(a, b)                  HMEMORY_FUNCTION_NAME(malloc_actual)(__FUNCTION__, __FILE__, __LINE__, a, b)
+#define hmemory_calloc(a, b, c)               HMEMORY_FUNCTION_NAME(calloc_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+#define hmemory_realloc(a, b, c)              HMEMORY_FUNCTION_NAME(realloc_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+#define hmemory_free(a)                       HMEMORY_FUNCTION_NAME(free_actual)(__FUNCTION__, __FILE__, __LINE__, a)
+
+#define hmemory_reallocarray(a, b, c, d)      HMEMORY_FUNCTION_NAME(reallocarray_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c, d)
+#define hmemory_posix_memalign(a, b, c, d)    HMEMORY_FUNCTION_NAME(posix_memalign_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c, d)
+#define hmemory_aligned_alloc(a, b, c)        HMEMORY_FUNCTION_NAME(aligned_alloc_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+#define hmemory_memalign(a, b, c)             HMEMORY_FUNCTION_NAME(memalign_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+#define hmemory_valloc(a, b)                  HMEMORY_FUNCTION_NAME(valloc_actual)(__FUNCTION__, __FILE__, __LINE__, a, b)
+#define hmemory_pvalloc(a, b)                 HMEMORY_FUNCTION_NAME(pvalloc_actual)(__FUNCTION__, __FILE__, __LINE__, a, b)
+#define hmemory_malloc_usable_size(a)         HMEMORY_FUNCTION_NAME(malloc_usable_size_actual)(__FUNCTION__, __FILE__, __LINE__, a)
+
+#define hmemory_new(a, b, c, d)               HMEMORY_FUNCTION_NAME(new_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c, d)
+#define hmemory_delete(a, b, c)               HMEMORY_FUNCTION_NAME(delete_actual)(__FUNCTION__, __FILE__, __LINE__, a, b, c)
+
+#define hmemory_information(a)                HMEMORY_FUNCTION_NAME(information_actual)(__FUNCTION__, __FILE__, __LINE__, a)
+
+struct hmemory_information {
+	unsigned long long current;
+	unsigned long long peak;
+	unsigned long long total;
+	unsigned long long blocks;
+	unsigned long long untracked;
+};
+
+#define hmemory_leaks(a)                      HMEMORY_FUNCTION_NAME(leaks_actual)(__FUNCTION__, __FILE__, __LINE__, a)
+
+struct hmemory_leaks {
+	unsigned long long definite_bytes;
+	unsigned long long definite_blocks;
+	unsigned long long indirect_bytes;
+	unsigned long long indirect_blocks;
+	unsigned long long reachable_bytes;
+	unsigned long long reachable_blocks;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void * HMEMORY_FUNCTION_NAME(memcpy_actual) (const char *func, const char *file, const int line, void *destination, const void *source, size_t len);
+void * HMEMORY_FUNCTION_NAME(memmove_actual) (const char *func, const char *file, const int line, void *destination, const void *source, size_t len);
+void * HMEMORY_FUNCTION_NAME(memset_actual) (const char *func, const char *file, const int line, void *destination, int c, size_t len);
+char * HMEMORY_FUNCTION_NAME(strcpy_actual) (const char *func, const char *file, const int line, char *destination, const char *source);
+char * HMEMORY_FUNCTION_NAME(strncpy_actual) (const char *func, const char *file, const int line, char *destination, const char *source, size_t len);
+char * HMEMORY_FUNCTION_NAME(strcat_actual) (const char *func, const char *file, const int line, char *destination, const char *source);
+int HMEMORY_FUNCTION_NAME(snprintf_actual) (const char *func, const char *file, const int line, char *destination, size_t len, const char *fmt, ...);
+
+ssize_t HMEMORY_FUNCTION_NAME(getline_actual) (const char *func, const char *file, const int line, const char *name, char **strp, size_t *n, FILE *stream);
+ssize_t HMEMORY_FUNCTION_NAME(getdelim_actual) (const char *func, const char *file, const int line, const char *name, char **strp, size_t *n, int delim, FILE *stream);
+
+int HMEMORY_FUNCTION_NAME(asprintf_actual) (const char *func, const char *file, const int line, const char *name, char **strp, const char *fmt, ...);
+int HMEMORY_FUNCTION_NAME(vasprintf_actual) (const char *func, const char *file, const int line, const char *name, char **strp, const char *fmt, va_list ap);
+
+char * HMEMORY_FUNCTION_NAME(strdup_actual) (const char *func, const char *file, const int line, const char *name, const char *string);
+char * HMEMORY_FUNCTION_NAME(strndup_actual) (const char *func, const char *file, const int line, const char *name, const char *string, size_t size);
+
+void * HMEMORY_FUNCTION_NAME(malloc_actual) (const char *func, const char *file, const int line, const char *name, size_t size);
+void * HMEMORY_FUNCTION_NAME(calloc_actual) (const char *func, const char *file, const int line, const char *name, size_t nmemb, size_t size);
+void * HMEMORY_FUNCTION_NAME(realloc_actual) (const char *func, const char *file, const int line, const char *name, void *address, size_t size);
+void HMEMORY_FUNCTION_NAME(free_actual) (const char *func, const char *file, const int line, void *address);
+
+void * HMEMORY_FUNCTION_NAME(reallocarray_actual) (const char *func, const char *file, const int line, const char *name, void *address, size_t nmemb, size_t size);
+int HMEMORY_FUNCTION_NAME(posix_memalign_actual) (const char *func, const char *file, const int line, const char *name, void **memptr, size_t alignment, size_t size);
+void * HMEMORY_FUNCTION_NAME(aligned_alloc_actual) (const char *func, const char *file, const int line, const char *name, size_t alignment, size_t size);
+void * HMEMORY_FUNCTION_NAME(memalign_actual) (const char *func, const char *file, const int line, const char *name, size_t alignment, size_t size);
+void * HMEMORY_FUNCTION_NAME(valloc_actual) (const char *func, const char *file, const int line, const char *name, size_t size);
+void * HMEMORY_FUNCTION_NAME(pvalloc_actual) (const char *func, const char *file, const int line, const char *name, size_t size);
+size_t HMEMORY_FUNCTION_NAME(malloc_usable_size_actual) (const char *func, const char *file, const int line, void *address);
+
+void * HMEMORY_FUNCTION_NAME(new_actual) (const char *func, const char *file, const int line, const char *name, int array, size_t alignment, size_t size);
+void HMEMORY_FUNCTION_NAME(delete_actual) (const char *func, const char *file, const int line, int array, size_t size, void *address);
+
+void * HMEMORY_FUNCTION_NAME(operator_new_actual) (void *caller, int array, size_t alignment, size_t size);
+void HMEMORY_FUNCTION_NAME(operator_delete_actual) (void *caller, int array, size_t size, void *address);
+
+int HMEMORY_FUNCTION_NAME(information_actual) (const char *func, const char *file, const int line, struct hmemory_information *information);
+int HMEMORY_FUNCTION_NAME(leaks_actual) (const char *func, const char *file, const int line, struct hmemory_leaks *leaks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -DHMEMORY_DEBUG=0   -M hmemory.c | sed 's,\(hmemory\.o\) *:,.libhmemory-actual.o/ .libhmemory-actual.o/hmemory.d: ,' > .libhmemory-actual.o/hmemory.d; cp -rf .libhmemory-actual.o/hmemory.d .libhmemory-actual.o/hmemory.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libhmemory-actual.o/hmemory.d >> .libhmemory-actual.o/hmemory.d.p; mv .libhmemory-actual.o/hmemory.d.p .libhmemory-actual.o/hmemory.d
@@ -0,0 +1 @@
+ld  -r -o .libhmemory-actual.o/libhmemory-actual.o .libhmemory-actual.o/hmemory.o
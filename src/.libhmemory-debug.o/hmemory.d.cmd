@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -DHMEMORY_DEBUG=1   -M hmemory.c | sed 's,\(hmemory\.o\) *:,.libhmemory-debug.o/ .libhmemory-debug.o/hmemory.d: ,' > .libhmemory-debug.o/hmemory.d; cp -rf .libhmemory-debug.o/hmemory.d .libhmemory-debug.o/hmemory.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .libhmemory-debug.o/hmemory.d >> .libhmemory-debug.o/hmemory.d.p; mv .libhmemory-debug.o/hmemory.d.p .libhmemory-debug.o/hmemory.d
@@ -0,0 +1 @@
+ld  -r -o .libhmemory-debug.o/libhmemory-debug.o .libhmemory-debug.o/hmemory.o
@@ -0,0 +1 @@
+ld  -r -o .libhmemory-new.o/libhmemory-new.o .libhmemory-new.o/hmemory-new.o
@@ -0,0 +1,2 @@
+ar rcs .libhmemory.a/libhmemory.a libhmemory.o
+ranlib .libhmemory.a/libhmemory.a
@@ -0,0 +1 @@
+ld  -r -o .libhmemory.o/libhmemory.o libhmemory-actual.o libhmemory-debug.o
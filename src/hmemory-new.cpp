@@ -0,0 +1,160 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <new>
+#include <cstdio>
+#include <cstdarg>
+#include <cstddef>
+
+#define HMEMORY_INTERNAL			1
+
+#include "hmemory.h"
+
+/*
+ * replacements for every global operator new and delete. blocks are tracked
+ * as new or new[], releasing them with the other form, or with free/realloc,
+ * is reported as mismatched. sized delete is checked against the block size.
+ * call sites are the return addresses of the operators.
+ */
+
+static void * hmemory_operator_new (void *caller, int array, std::size_t alignment, std::size_t size)
+{
+	void *rc;
+	std::new_handler handler;
+	while (1) {
+		rc = HMEMORY_FUNCTION_NAME(operator_new_actual)(caller, array, alignment, size);
+		if (rc != NULL) {
+			return rc;
+		}
+		handler = std::get_new_handler();
+		if (handler == NULL) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+static void * hmemory_operator_new_nothrow (void *caller, int array, std::size_t alignment, std::size_t size) noexcept
+{
+	try {
+		return hmemory_operator_new(caller, array, alignment, size);
+	} catch (...) {
+		return NULL;
+	}
+}
+
+static inline void hmemory_operator_delete (void *caller, int array, std::size_t size, void *address) noexcept
+{
+	HMEMORY_FUNCTION_NAME(operator_delete_actual)(caller, array, size, address);
+}
+
+void * operator new (std::size_t size)
+{
+	return hmemory_operator_new(__builtin_return_address(0), 0, 0, size);
+}
+
+void * operator new[] (std::size_t size)
+{
+	return hmemory_operator_new(__builtin_return_address(0), 1, 0, size);
+}
+
+void * operator new (std::size_t size, const std::nothrow_t &) noexcept
+{
+	return hmemory_operator_new_nothrow(__builtin_return_address(0), 0, 0, size);
+}
+
+void * operator new[] (std::size_t size, const std::nothrow_t &) noexcept
+{
+	return hmemory_operator_new_nothrow(__builtin_return_address(0), 1, 0, size);
+}
+
+void operator delete (void *address) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 0, 0, address);
+}
+
+void operator delete[] (void *address) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 1, 0, address);
+}
+
+void operator delete (void *address, const std::nothrow_t &) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 0, 0, address);
+}
+
+void operator delete[] (void *address, const std::nothrow_t &) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 1, 0, address);
+}
+
+void operator delete (void *address, std::size_t size) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 0, size, address);
+}
+
+void operator delete[] (void *address, std::size_t size) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 1, size, address);
+}
+
+#if defined(__cpp_aligned_new)
+
+void * operator new (std::size_t size, std::align_val_t alignment)
+{
+	return hmemory_operator_new(__builtin_return_address(0), 0, static_cast<std::size_t>(alignment), size);
+}
+
+void * operator new[] (std::size_t size, std::align_val_t alignment)
+{
+	return hmemory_operator_new(__builtin_return_address(0), 1, static_cast<std::size_t>(alignment), size);
+}
+
+void * operator new (std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+	return hmemory_operator_new_nothrow(__builtin_return_address(0), 0, static_cast<std::size_t>(alignment), size);
+}
+
+void * operator new[] (std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+	return hmemory_operator_new_nothrow(__builtin_return_address(0), 1, static_cast<std::size_t>(alignment), size);
+}
+
+void operator delete (void *address, std::align_val_t) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 0, 0, address);
+}
+
+void operator delete[] (void *address, std::align_val_t) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 1, 0, address);
+}
+
+void operator delete (void *address, std::align_val_t, const std::nothrow_t &) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 0, 0, address);
+}
+
+void operator delete[] (void *address, std::align_val_t, const std::nothrow_t &) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 1, 0, address);
+}
+
+void operator delete (void *address, std::size_t size, std::align_val_t) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 0, size, address);
+}
+
+void operator delete[] (void *address, std::size_t size, std::align_val_t) noexcept
+{
+	hmemory_operator_delete(__builtin_return_address(0), 1, size, address);
+}
+
+#endif
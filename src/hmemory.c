@@ -10,24 +10,73 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdarg.h>
 #include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
 #include <errno.h>
+#include <signal.h>
+#include <fnmatch.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <assert.h>
+#include <malloc.h>
 #if defined(__DARWIN__) && (__DARWIN__ == 1)
 #include <mach/mach_time.h>
 #endif
 
 #define HMEMORY_INTERNAL			1
 #define HMEMORY_CALLSTACK_MAX			128
+#define HMEMORY_CACHELINE_SIZE			64
+#define HMEMORY_HISTOGRAM_BUCKETS		65
+#define HMEMORY_HISTOGRAM_CLASSES		128
+#define HMEMORY_SCAN_NONE			(~0U)
 
+#include "hmemory.h"
+
+/*
+ * with HMEMORY_ARENA_RECORDS, records of tracked blocks come from a static
+ * array and are kept in a uthash table whose buckets are static too, as
+ * many as the records rounded up to a power of two, and never expanded.
+ */
+#if (HMEMORY_ARENA_RECORDS > 0) && defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+#define HMEMORY_HASH_UTHASH			1
+#define HMEMORY_HASH_KHASH			0
+#define HMEMORY_ARENA_BUCKETS			(1ULL << (64 - __builtin_clzll(((unsigned long long) HMEMORY_ARENA_RECORDS - 1) | 1)))
+#define HASH_INITIAL_NUM_BUCKETS		HMEMORY_ARENA_BUCKETS
+#define HASH_INITIAL_NUM_BUCKETS_LOG2		__builtin_ctzll(HMEMORY_ARENA_BUCKETS)
+#define HASH_BKT_CAPACITY_THRESH		(~0U)
+#define HASH_FUNCTION(key, keylen, num_bkts, hashv, bkt) do { \
+	hashv = (unsigned int) ((((uint64_t) *(const uintptr_t *) (key)) * 0x9e3779b97f4a7c15ULL) >> 32); \
+	bkt = hashv & ((num_bkts) - 1); \
+} while (0)
+#define uthash_malloc(size)			debug_arena_table(size)
+#define uthash_free(ptr, size)
+static void * debug_arena_table (size_t size);
+#else
 #define HMEMORY_HASH_UTHASH			0
 #define HMEMORY_HASH_KHASH			1
+#endif
+
+/*
+ * tables of the tracker take their storage from the metadata allocator, see
+ * debug_metadata_malloc.
+ */
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+#define kmalloc(size)				debug_metadata_malloc(size)
+#define kcalloc(nmemb, size)			debug_metadata_calloc(nmemb, size)
+#define krealloc(address, size)			debug_metadata_realloc(address, size)
+#define kfree(address)				debug_metadata_free(address)
+static void * debug_metadata_malloc (size_t size);
+static void * debug_metadata_calloc (size_t nmemb, size_t size);
+static void * debug_metadata_realloc (void *address, size_t size);
+static void debug_metadata_free (void *address);
+#endif
 
-#include "hmemory.h"
 #include "khash.h"
 #include "uthash.h"
 
@@ -37,6 +86,17 @@
 #include <execinfo.h>
 #endif
 
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+#include <dlfcn.h>
+#endif
+
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+#if !defined(HMEMORY_DEBUG) || (HMEMORY_DEBUG == 0)
+#error "preload requires HMEMORY_DEBUG=1"
+#endif
+#include <link.h>
+#endif
+
 static pthread_mutex_t debugf_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 #define hdebug_lock() pthread_mutex_lock(&debugf_mutex);
@@ -70,10 +130,7 @@ static pthread_mutex_t debugf_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 #define hassert(a) { \
 	unsigned int v; \
-	v = hmemory_getenv_int(HMEMORY_ASSERT_ON_ERROR_NAME); \
-	if (v == (unsigned int) -1) { \
-		v = HMEMORY_ASSERT_ON_ERROR; \
-	} \
+	v = hconfig(assert_on_error); \
 	if (v) { \
 		assert(a); \
 	} else { \
@@ -90,28 +147,172 @@ static pthread_mutex_t debugf_mutex = PTHREAD_MUTEX_INITIALIZER;
 	hdebug_unlock(); \
 }
 
+/*
+ * how a block was allocated, it must be released the same way: malloc family
+ * with free or realloc, new with delete and new[] with delete[].
+ */
+enum {
+	HMEMORY_KIND_MALLOC,
+	HMEMORY_KIND_NEW,
+	HMEMORY_KIND_NEW_ARRAY,
+	HMEMORY_KIND_MAX
+};
+
+/*
+ * a large block is mapped directly, the record keeps which of the guard
+ * pages around the mapping it owns.
+ */
+enum {
+	HMEMORY_LARGE_MAPPED	= 0x1,
+	HMEMORY_LARGE_HEAD	= 0x2,
+	HMEMORY_LARGE_TAIL	= 0x4,
+	HMEMORY_LARGE_GUARDED	= HMEMORY_LARGE_MAPPED | HMEMORY_LARGE_HEAD | HMEMORY_LARGE_TAIL
+};
+
 #if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
 
 #define hmemory_lock()			pthread_mutex_lock(&hmemory_mutex)
 #define hmemory_unlock()		pthread_mutex_unlock(&hmemory_mutex)
 #define hmemory_self_pthread()		pthread_self()
 
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+#define HMEMORY_MUTEX_INITIALIZER	PTHREAD_ERRORCHECK_MUTEX_INITIALIZER_NP
+#else
+#define HMEMORY_MUTEX_INITIALIZER	PTHREAD_MUTEX_INITIALIZER
+#endif
+
 static pthread_cond_t hmemory_cond	= PTHREAD_COND_INITIALIZER;
-static pthread_mutex_t hmemory_mutex	= PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t hmemory_mutex	= HMEMORY_MUTEX_INITIALIZER;
 
 static intptr_t  hmemory_signature	= 0xdeadbeef;
 static intptr_t  hmemory_signature_size = sizeof(hmemory_signature);
+#if (HMEMORY_ARENA_RECORDS > 0)
+/* room for base, size and kind of blocks that are not tracked, see debug_arena_untrack */
+static intptr_t  hmemory_head_size	= (sizeof(hmemory_signature) + sizeof(void *) + sizeof(size_t) * 2 + __alignof__(max_align_t) - 1) & ~(__alignof__(max_align_t) - 1);
+#else
+static intptr_t  hmemory_head_size	= (sizeof(hmemory_signature) + __alignof__(max_align_t) - 1) & ~(__alignof__(max_align_t) - 1);
+#endif
+
+/*
+ * hmemory_* settings are parsed once into an immutable snapshot, from the
+ * environment and then hmemory_config_file. readers load the current
+ * snapshot without locking, a reload publishes a new one and keeps the old
+ * ones around, a reader may still be looking at them.
+ */
+struct hmemory_config {
+	int assert_on_error;
+	int report_callstack;
+	int check_interval;
+	int show_reachable;
+	int report_histogram;
+	int report_copy;
+	int leak_check;
+	int leak_threads;
+	int leak_top;
+	int fast_exit;
+	int leak_interval;
+	int leak_signal;
+	int fork_statistics;
+	int large_threshold;
+	int table_capacity;
+	int metadata_region;
+	char histogram_file[1024];
+	char suppressions[1024];
+	char config_file[1024];
+	struct hmemory_config *previous;
+};
+
+static struct hmemory_config hmemory_config_defaults = {
+	.assert_on_error	= HMEMORY_ASSERT_ON_ERROR,
+	.report_callstack	= HMEMORY_REPORT_CALLSTACK,
+	.check_interval		= -1,
+	.show_reachable		= HMEMORY_SHOW_REACHABLE,
+	.report_histogram	= HMEMORY_REPORT_HISTOGRAM,
+	.report_copy		= HMEMORY_REPORT_COPY,
+	.leak_check		= HMEMORY_LEAK_CHECK,
+	.leak_threads		= HMEMORY_LEAK_THREADS,
+	.leak_top		= HMEMORY_LEAK_TOP,
+	.fast_exit		= HMEMORY_FAST_EXIT,
+	.leak_interval		= HMEMORY_LEAK_INTERVAL,
+	.leak_signal		= HMEMORY_LEAK_SIGNAL,
+	.fork_statistics	= HMEMORY_FORK_STATISTICS,
+	.large_threshold	= HMEMORY_LARGE_THRESHOLD,
+	.table_capacity		= HMEMORY_TABLE_CAPACITY,
+	.metadata_region	= HMEMORY_METADATA_REGION,
+};
+
+static struct hmemory_config *hmemory_config = &hmemory_config_defaults;
+
+#define hconfig(a)			(__atomic_load_n(&hmemory_config, __ATOMIC_ACQUIRE)->a)
 
-static inline int hmemory_getenv_int (const char *name);
 static inline int debug_dump_callstack (const char *prefix);
-static inline int debug_memory_add (const char *name, void *address, size_t size, const char *command, const char *func, const char *file, const int line);
+static const char *hmemory_kinds[HMEMORY_KIND_MAX] = {
+	"malloc",
+	"new",
+	"new[]",
+};
+
+enum {
+	HMEMORY_COPY_MEMCPY,
+	HMEMORY_COPY_MEMMOVE,
+	HMEMORY_COPY_MEMSET,
+	HMEMORY_COPY_STRCPY,
+	HMEMORY_COPY_STRNCPY,
+	HMEMORY_COPY_STRCAT,
+	HMEMORY_COPY_OPS
+};
+
+struct hmemory_memory;
+
+static inline int debug_memory_add (const char *name, int kind, int large, void *base, void *address, size_t size, const char *command, const char *func, const char *file, const int line);
 static inline int debug_memory_check (void *address, const char *command, const char *func, const char *file, const int line);
 static inline int debug_memory_overlap (void *s1, const void *s2, size_t len, const char *command, const char *func, const char *file, const int line);
-static inline int debug_memory_del (void *address, const char *command, const char *func, const char *file, const int line);
+static inline int debug_memory_del (void *address, int kind, size_t length, void **base, size_t *size, const char *command, const char *func, const char *file, const int line);
+static inline int debug_memory_find (void *address, void **base, size_t *size, int *kind);
+static inline void debug_copy_add (int op, size_t len, const char *func, const char *file, const int line);
+static inline int debug_memory_bounds (const void *address, size_t len, const char *what, const char *command, const char *func, const char *file, const int line);
+static inline struct hmemory_memory * debug_memory_acquire (void *address, int kind, void **base, size_t *size, const char *command, const char *func, const char *file, const int line);
+static inline int debug_memory_resize (struct hmemory_memory *m, void *base, void *address, size_t size, const char *func, const char *file, const int line);
+static inline int debug_suppressed (const char *func, const char *file, const int line);
+static inline int debug_large_wanted (size_t size);
+static inline void * debug_large_map (size_t size);
+static inline void debug_large_unmap (void *base, size_t size, int large);
+static inline void * debug_large_remap (struct hmemory_memory *m, size_t size);
+static inline int debug_memory_large (struct hmemory_memory *m);
+static inline int debug_arena_untracked (void *address, void **base, size_t *size, int *large);
+
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+
+/*
+ * when preloaded, hmemory itself and the libraries it calls allocate through
+ * the interposed functions. the guard is set while inside hmemory, and such
+ * nested calls go straight to the next allocator untracked. it must live in
+ * static tls, dynamic tls may allocate on first access. libraries may still
+ * release tracked blocks from nested calls (pthread_join frees dtv), so the
+ * mutex is error checking: finding it already owned means the caller is
+ * hmemory itself, releasing its own memory.
+ */
+static __thread int hmemory_preload_guard __attribute__ ((tls_model("initial-exec")));
+static int hmemory_preload_active;
+static void *hmemory_preload_loader;
+
+static void debug_preload_init (void);
+static void debug_preload_free (void *address);
+
+#define hpreload_guard(a)		hmemory_preload_guard = (a)
+#define hpreload_free(a)		debug_preload_free(a)
+
+#else
+
+#define hpreload_guard(a)
+#define hpreload_free(a)		free(a)
+
+#endif
 
 #else
 
 static unsigned int hmemory_signature_size = 0;
+static unsigned int hmemory_head_size = 0;
 
 #define debug_memory_unused() \
 	(void) func; \
@@ -121,832 +322,6060 @@ static unsigned int hmemory_signature_size = 0;
 #define debug_memory_del(a...)		debug_memory_unused()
 #define debug_memory_check(a...)	debug_memory_unused()
 #define debug_memory_overlap(a...)      debug_memory_unused()
+#define debug_copy_add(a...)		debug_memory_unused()
+#define debug_memory_bounds(a...)	debug_memory_unused()
+#define debug_large_wanted(a...)	0
+#define debug_large_map(a...)		NULL
 
 #endif
 
-static inline void * malloc_actual (const char *command, const char *func, const char *file, const int line, const char *name, size_t size)
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1) && defined(HMEMORY_ENABLE_PROFILE) && (HMEMORY_ENABLE_PROFILE == 1)
+
+/*
+ * self overhead profiling. every public wrapper opens a scope, and time spent
+ * inside is charged exclusively to the innermost active phase; nested phases
+ * pause their parent. on scope exit the total and per phase times are added
+ * to log2 nanosecond histograms of the wrapper.
+ */
+enum {
+	HMEMORY_PROFILE_MEMCPY,
+	HMEMORY_PROFILE_MEMMOVE,
+	HMEMORY_PROFILE_MEMSET,
+	HMEMORY_PROFILE_STRCPY,
+	HMEMORY_PROFILE_STRNCPY,
+	HMEMORY_PROFILE_STRCAT,
+	HMEMORY_PROFILE_SNPRINTF,
+	HMEMORY_PROFILE_GETLINE,
+	HMEMORY_PROFILE_GETDELIM,
+	HMEMORY_PROFILE_ASPRINTF,
+	HMEMORY_PROFILE_VASPRINTF,
+	HMEMORY_PROFILE_STRDUP,
+	HMEMORY_PROFILE_STRNDUP,
+	HMEMORY_PROFILE_MALLOC,
+	HMEMORY_PROFILE_CALLOC,
+	HMEMORY_PROFILE_REALLOC,
+	HMEMORY_PROFILE_FREE,
+	HMEMORY_PROFILE_MEMALIGN,
+	HMEMORY_PROFILE_NEW,
+	HMEMORY_PROFILE_DELETE,
+	HMEMORY_PROFILE_WRAPPERS
+};
+
+enum {
+	HMEMORY_PROFILE_SELF,
+	HMEMORY_PROFILE_ALLOCATOR,
+	HMEMORY_PROFILE_LOCK,
+	HMEMORY_PROFILE_TRACKER,
+	HMEMORY_PROFILE_CHECK,
+	HMEMORY_PROFILE_PHASES
+};
+
+static const char *hmemory_profile_wrappers[HMEMORY_PROFILE_WRAPPERS] = {
+	"memcpy",
+	"memmove",
+	"memset",
+	"strcpy",
+	"strncpy",
+	"strcat",
+	"snprintf",
+	"getline",
+	"getdelim",
+	"asprintf",
+	"vasprintf",
+	"strdup",
+	"strndup",
+	"malloc",
+	"calloc",
+	"realloc",
+	"free",
+	"memalign",
+	"new",
+	"delete",
+};
+
+static const char *hmemory_profile_phases[HMEMORY_PROFILE_PHASES] = {
+	"self",
+	"allocator",
+	"lock",
+	"tracker",
+	"check",
+};
+
+struct hmemory_profile {
+	unsigned long long calls;
+	unsigned long long total[HMEMORY_HISTOGRAM_BUCKETS];
+	unsigned long long phase[HMEMORY_PROFILE_PHASES][HMEMORY_HISTOGRAM_BUCKETS];
+	unsigned long long sum[HMEMORY_PROFILE_PHASES];
+};
+
+struct hmemory_profile_thread {
+	int depth;
+	int current;
+	unsigned long long start;
+	unsigned long long phase[HMEMORY_PROFILE_PHASES];
+};
+
+static struct hmemory_profile hmemory_profile[HMEMORY_PROFILE_WRAPPERS];
+static __thread struct hmemory_profile_thread hmemory_profile_thread;
+static unsigned long long hmemory_profile_locks;
+static unsigned long long hmemory_profile_contended;
+
+static inline unsigned long long debug_getclock_ns (void);
+
+static inline int debug_profile_push (int phase)
 {
-	void *rc;
-	size += hmemory_signature_size * 2;
-	rc = malloc(size);
-	if (rc == NULL) {
-		herrorf("malloc failed");
-		return NULL;
-	}
-	debug_memory_add(name, rc, size, command, func, file, line);
-	debug_memory_check(rc, command, func, file, line);
-	return rc + hmemory_signature_size;
+	int prev;
+	unsigned long long now;
+	struct hmemory_profile_thread *t;
+	t = &hmemory_profile_thread;
+	now = debug_getclock_ns();
+	t->phase[t->current] += now - t->start;
+	prev = t->current;
+	t->current = phase;
+	t->start = now;
+	return prev;
 }
 
-static inline void free_actual (const char *command, const char *func, const char *file, const int line, void *address)
+static inline void debug_profile_pop (int *prev)
 {
-	void *addr;
-	(void) command;
-	if (address == NULL) {
-		return;
+	unsigned long long now;
+	struct hmemory_profile_thread *t;
+	t = &hmemory_profile_thread;
+	now = debug_getclock_ns();
+	t->phase[t->current] += now - t->start;
+	t->current = *prev;
+	t->start = now;
+}
+
+static inline int debug_profile_begin (int wrapper)
+{
+	struct hmemory_profile_thread *t;
+	t = &hmemory_profile_thread;
+	if (t->depth++ == 0) {
+		memset(t->phase, 0, sizeof(t->phase));
+		t->current = HMEMORY_PROFILE_SELF;
+		t->start = debug_getclock_ns();
 	}
-	addr = address - hmemory_signature_size;
-	debug_memory_check(addr, command, func, file, line);
-	debug_memory_del(addr, command, func, file, line);
-	free(addr);
+	return wrapper;
 }
 
-void * HMEMORY_FUNCTION_NAME(memcpy_actual) (const char *func, const char *file, const int line, void *s1, const void *s2, size_t len)
+static inline unsigned int debug_profile_log2 (unsigned long long value)
 {
-	debug_memory_overlap(s1, s2, len, "memcpy", func, file, line);
-	return memcpy(s1, s2, len);
+	return (value == 0) ? 0 : (64 - __builtin_clzll(value));
 }
 
-int HMEMORY_FUNCTION_NAME(getline_actual) (const char *func, const char *file, const int line, const char *name, char **strp, size_t *n, FILE *stream)
+static inline void debug_profile_end (int *wrapper)
 {
-	int rc;
-	if (*strp != NULL) {
-		free_actual("getline", func, file, line, *strp);
-		*strp = NULL;
-		*n = 0;
-	}
-	rc = getline(strp, n, stream);
-	if (rc < 0 && errno == EINVAL) {
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-		hdebug_lock();
-		hinfof("getline failed");
-		hinfof("    at: %s %s:%d", func, file, line);
-		debug_dump_callstack("       ");
-		hdebug_unlock();
-		hassert((rc >= 0) && "getline failed");
-#endif
+	int i;
+	unsigned long long total;
+	struct hmemory_profile *p;
+	struct hmemory_profile_thread *t;
+	t = &hmemory_profile_thread;
+	if (--t->depth != 0) {
+		return;
 	}
-	if (*strp != NULL) {
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-		void *tmp;
-		tmp = malloc_actual("getline", func, file, line, name, strlen(*strp) + 1);
-		memcpy(tmp, *strp, strlen(*strp) + 1);
-		free(*strp);
-		*strp = tmp;
-#else
-		(void) name;
-		(void) func;
-		(void) file;
-		(void) line;
-#endif
+	t->phase[t->current] += debug_getclock_ns() - t->start;
+	p = &hmemory_profile[*wrapper];
+	total = 0;
+	for (i = 0; i < HMEMORY_PROFILE_PHASES; i++) {
+		total += t->phase[i];
+		__atomic_fetch_add(&p->sum[i], t->phase[i], __ATOMIC_RELAXED);
+		__atomic_fetch_add(&p->phase[i][debug_profile_log2(t->phase[i])], 1, __ATOMIC_RELAXED);
 	}
-	return rc;
+	__atomic_fetch_add(&p->total[debug_profile_log2(total)], 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&p->calls, 1, __ATOMIC_RELAXED);
 }
 
-
-int HMEMORY_FUNCTION_NAME(asprintf_actual) (const char *func, const char *file, const int line, const char *name, char **strp, const char *fmt, ...)
+static inline int debug_profile_lock (pthread_mutex_t *mutex)
 {
 	int rc;
-	va_list ap;
-	va_start(ap, fmt);
-	rc = vasprintf(strp, fmt, ap);
-	if (rc < 0) {
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-		hdebug_lock();
-		hinfof("asprintf failed");
-		hinfof("    at: %s %s:%d", func, file, line);
-		debug_dump_callstack("       ");
-		hdebug_unlock();
-		hassert((rc >= 0) && "asprintf failed");
-#endif
-	} else {
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-		void *tmp;
-		tmp = malloc_actual("asprintf", func, file, line, name, strlen(*strp) + 1);
-		memcpy(tmp, *strp, strlen(*strp) + 1);
-		free(*strp);
-		*strp = tmp;
-#else
-		(void) name;
-		(void) func;
-		(void) file;
-		(void) line;
-#endif
+	int prev;
+	__atomic_fetch_add(&hmemory_profile_locks, 1, __ATOMIC_RELAXED);
+	if (pthread_mutex_trylock(mutex) == 0) {
+		return 0;
 	}
-	va_end(ap);
+	__atomic_fetch_add(&hmemory_profile_contended, 1, __ATOMIC_RELAXED);
+	prev = debug_profile_push(HMEMORY_PROFILE_LOCK);
+	rc = pthread_mutex_lock(mutex);
+	debug_profile_pop(&prev);
 	return rc;
 }
 
-int HMEMORY_FUNCTION_NAME(vasprintf_actual) (const char *func, const char *file, const int line, const char *name, char **strp, const char *fmt, va_list ap)
-{
-	int rc;
-	rc = vasprintf(strp, fmt, ap);
-	if (rc < 0) {
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-		hdebug_lock();
-		hinfof("vasprintf failed");
-		hinfof("    at: %s %s:%d", func, file, line);
-		debug_dump_callstack("       ");
-		hdebug_unlock();
-		hassert((rc >= 0) && "vasprintf failed");
-#endif
-	} else {
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-		void *tmp;
-		tmp = malloc_actual("vasprintf", func, file, line, name, strlen(*strp) + 1);
-		memcpy(tmp, *strp, strlen(*strp) + 1);
-		free(*strp);
-		*strp = tmp;
+#undef hmemory_lock
+#define hmemory_lock()			debug_profile_lock(&hmemory_mutex)
+
+#define hprofile_scope(wrapper)		int __hprofile_wrapper __attribute__ ((cleanup(debug_profile_end))) = debug_profile_begin(HMEMORY_PROFILE_ ## wrapper)
+#define hprofile_phase_scope(phase)	int __hprofile_phase __attribute__ ((cleanup(debug_profile_pop))) = debug_profile_push(HMEMORY_PROFILE_ ## phase)
+#define hprofile_phase(phase, a...)	{ hprofile_phase_scope(phase); a; }
+
 #else
-		(void) name;
-		(void) func;
-		(void) file;
-		(void) line;
+
+#define hprofile_scope(wrapper)
+#define hprofile_phase_scope(phase)
+#define hprofile_phase(phase, a...)	{ a; }
+
 #endif
-	}
-	return rc;
+
+static inline int debug_power_of_two (size_t value)
+{
+	return (value != 0) && ((value & (value - 1)) == 0);
 }
 
-char * HMEMORY_FUNCTION_NAME(strdup_actual) (const char *func, const char *file, const int line, const char *name, const char *string)
+/*
+ * requests are bounded at PTRDIFF_MAX, as glibc does, with the alignment
+ * slack, the head and the signatures included, so that none of the size
+ * arithmetic below can wrap.
+ */
+static inline int debug_size_overflow (size_t size, size_t alignment)
 {
-	void *rc;
-	if (string == NULL) {
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-		hdebug_lock();
-		hinfof("strdup with invalid argument '%p'", string);
-		hinfof("    at: %s %s:%d", func, file, line);
-		debug_dump_callstack("       ");
-		hdebug_unlock();
-		hassert((string != NULL) && "invalid strdup parameter");
-#endif
-		return NULL;
-	}
-	rc = strdup(string);
-	if (rc == NULL) {
-		herrorf("strdup failed");
+	size_t slack;
+	slack = alignment + hmemory_head_size + hmemory_signature_size * 2;
+	return (alignment > PTRDIFF_MAX / 2) || (size > PTRDIFF_MAX - slack);
+}
+
+/*
+ * memalign takes any alignment and rounds it up to a power of two, returns
+ * 0 for alignments that have none.
+ */
+static inline size_t debug_alignment_round (size_t alignment)
+{
+	size_t power;
+	if (alignment > (SIZE_MAX >> 1) + 1) {
+		return 0;
 	}
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-	{
-		void *tmp;
-		tmp = malloc_actual("strdup", func, file, line, name, strlen(rc) + 1);
-		memcpy(tmp, rc, strlen(rc) + 1);
-		free(rc);
-		rc = tmp;
+	for (power = 1; power < alignment; power <<= 1) {
 	}
-#else
-	(void) name;
-	(void) func;
-	(void) file;
-	(void) line;
-#endif
-	return rc;
+	return power;
+}
 
+/*
+ * pvalloc rounds the size up to whole pages, at least one, returns -1 if
+ * the rounded size is not representable.
+ */
+static inline int debug_page_round (size_t *size, size_t page)
+{
+	if (*size > SIZE_MAX - page) {
+		return -1;
+	}
+	*size = (*size == 0) ? page : ((*size + page - 1) & ~(page - 1));
+	return 0;
 }
 
-char * HMEMORY_FUNCTION_NAME(strndup_actual) (const char *func, const char *file, const int line, const char *name, const char *string, size_t size)
+/*
+ * block layout, the tracked address is the head signature and base is what
+ * the allocator returned and what is freed:
+ *
+ *   base                 address     address + sig           + size
+ *   | pad to head size   | signature | user data ...         | signature |
+ *
+ * head is padded to the alignment of max_align_t, so pointers handed out
+ * keep the alignment malloc guarantees.
+ */
+static inline void * malloc_actual (const char *command, const char *func, const char *file, const int line, const char *name, int kind, size_t size)
 {
+	int large;
 	void *rc;
-	if (string == NULL) {
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-		hdebug_lock();
-		hinfof("strdup with invalid argument '%p'", string);
-		hinfof("    at: %s %s:%d", func, file, line);
-		debug_dump_callstack("       ");
-		hdebug_unlock();
-		hassert((string != NULL) && "invalid strndup parameter");
-#endif
+	void *base;
+	(void) kind;
+	if (debug_size_overflow(size, 0)) {
+		herrorf("malloc overflow");
+		errno = ENOMEM;
 		return NULL;
 	}
-	rc = strndup(string, size);
-	if (rc == NULL) {
-		herrorf("strndup failed");
+	large = (debug_large_wanted(size)) ? HMEMORY_LARGE_GUARDED : 0;
+	size += hmemory_signature_size * 2;
+	if (large) {
+		hprofile_phase(ALLOCATOR, base = debug_large_map(size));
+	} else {
+		hprofile_phase(ALLOCATOR, base = malloc(hmemory_head_size - hmemory_signature_size + size));
 	}
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-	{
-		void *tmp;
-		tmp = malloc_actual("strndup", func, file, line, name, strlen(rc) + 1);
-		memcpy(tmp, rc, strlen(rc) + 1);
-		free(rc);
-		rc = tmp;
+	if (base == NULL) {
+		herrorf("malloc failed");
+		return NULL;
 	}
-#else
-	(void) name;
-	(void) func;
-	(void) file;
-	(void) line;
-#endif
-	return rc;
+	rc = base + hmemory_head_size - hmemory_signature_size;
+	debug_memory_add(name, kind, large, base, rc, size, command, func, file, line);
+	debug_memory_check(rc, command, func, file, line);
+	return rc + hmemory_signature_size;
 }
 
-void * HMEMORY_FUNCTION_NAME(malloc_actual) (const char *func, const char *file, const int line, const char *name, size_t size)
+/*
+ * calloc is served by the real calloc, which skips clearing memory that is
+ * known to be zero (fresh mmap chunks of large requests), so only the pages
+ * holding the signatures are touched.
+ */
+static inline void * calloc_actual (const char *command, const char *func, const char *file, const int line, const char *name, size_t nmemb, size_t size)
 {
+	int large;
 	void *rc;
-	rc = malloc_actual("malloc", func, file, line, name, size);
-	if (rc == NULL) {
-		herrorf("malloc_actual failed");
+	void *base;
+	if (__builtin_mul_overflow(nmemb, size, &size) || debug_size_overflow(size, 0)) {
+		herrorf("calloc overflow");
+		errno = ENOMEM;
 		return NULL;
 	}
-	return rc;
+	large = (debug_large_wanted(size)) ? HMEMORY_LARGE_GUARDED : 0;
+	size += hmemory_signature_size * 2;
+	if (large) {
+		hprofile_phase(ALLOCATOR, base = debug_large_map(size));
+	} else {
+		hprofile_phase(ALLOCATOR, base = calloc(1, hmemory_head_size - hmemory_signature_size + size));
+	}
+	if (base == NULL) {
+		herrorf("calloc failed");
+		return NULL;
+	}
+	rc = base + hmemory_head_size - hmemory_signature_size;
+	debug_memory_add(name, HMEMORY_KIND_MALLOC, large, base, rc, size, command, func, file, line);
+	debug_memory_check(rc, command, func, file, line);
+	return rc + hmemory_signature_size;
 }
 
-void * HMEMORY_FUNCTION_NAME(calloc_actual) (const char *func, const char *file, const int line, const char *name, size_t nmemb, size_t size)
+/*
+ * aligned blocks are allocated with enough slack in front so that the head
+ * signature ends exactly at an aligned address. alignments malloc already
+ * satisfies use the malloc layout, such blocks can be resized in place.
+ */
+static inline void * memalign_actual (const char *command, const char *func, const char *file, const int line, const char *name, int kind, size_t alignment, size_t size)
 {
+	int ret;
 	void *rc;
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
-	rc = malloc_actual("calloc", func, file, line, name, nmemb * size);
-	if (rc == NULL) {
-		herrorf("malloc actual failed");
-		return NULL;
+	void *base;
+	size_t offset;
+	(void) kind;
+	base = NULL;
+	if (alignment <= __alignof__(max_align_t)) {
+		return malloc_actual(command, func, file, line, name, kind, size);
 	}
-	rc = memset(rc, 0, nmemb * size);
-	if (rc == NULL) {
-		herrorf("memset actual failed");
+	if (debug_size_overflow(size, alignment)) {
+		herrorf("memalign overflow");
+		errno = ENOMEM;
 		return NULL;
 	}
-#else
-	(void) name;
-	(void) func;
-	(void) file;
-	(void) line;
-	rc = calloc(nmemb, size);
-	if (rc == NULL) {
-		herrorf("calloc failed");
+	offset = (hmemory_signature_size + alignment - 1) & ~(alignment - 1);
+	size += hmemory_signature_size * 2;
+	hprofile_phase(ALLOCATOR, ret = posix_memalign(&base, alignment, offset - hmemory_signature_size + size));
+	if (ret != 0) {
+		herrorf("posix_memalign failed");
 		return NULL;
 	}
-#endif
-	return rc;
+	rc = base + offset - hmemory_signature_size;
+	debug_memory_add(name, kind, 0, base, rc, size, command, func, file, line);
+	debug_memory_check(rc, command, func, file, line);
+	return rc + hmemory_signature_size;
 }
 
-void * HMEMORY_FUNCTION_NAME(realloc_actual) (const char *func, const char *file, const int line, const char *name, void *address, size_t size)
+static inline void free_actual (const char *command, const char *func, const char *file, const int line, int kind, size_t length, void *address)
 {
-	void *rc;
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
 	void *addr;
-	if (address == NULL) {
-		rc = malloc_actual("realloc", func, file, line, name, size);
-		if (rc == NULL) {
-			herrorf("malloc_actual failed");
-			return NULL;
-		}
-		return rc;
+	void *base;
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	int large;
+	size_t size;
+#endif
+	(void) command;
+	(void) kind;
+	(void) length;
+	if (address == NULL) {
+		return;
 	}
-	size += hmemory_signature_size * 2;
 	addr = address - hmemory_signature_size;
-	debug_memory_check(addr, "realloc", func, file, line);
-	debug_memory_del(addr, "realloc", func, file, line);
-	rc = realloc(addr, size);
-	if (rc == NULL) {
-		debug_memory_add(name, addr, size, "realloc", func, file, line);
-		herrorf("realloc failed");
-		return NULL;
+	base = addr;
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	large = debug_memory_del(addr, kind, length, &base, &size, command, func, file, line);
+	if (large == -1) {
+		return;
 	}
-	debug_memory_add(name, rc, size, "realloc", func, file, line);
-	debug_memory_check(rc, "realloc", func, file, line);
-	return rc + hmemory_signature_size;
-#else
-	(void) name;
-	(void) func;
-	(void) file;
-	(void) line;
-	rc = realloc(address, size);
-	if (rc == NULL) {
-		herrorf("realloc failed");
-		return NULL;
+	if (large > 0) {
+		hprofile_phase(ALLOCATOR, debug_large_unmap(base, size, large));
+		return;
+	}
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+	if (large == -2) {
+		hprofile_phase(ALLOCATOR, hpreload_free(address));
+		return;
 	}
 #endif
+	hprofile_phase(ALLOCATOR, hpreload_free(base));
+#else
+	debug_memory_del(addr, kind, length, &base, NULL, command, func, file, line);
+	hprofile_phase(ALLOCATOR, free(base));
+#endif
+}
+
+/*
+ * the string is sized with a first vsnprintf pass and then printed straight
+ * into the tracked block, instead of letting libc allocate a copy of its own.
+ */
+static inline int vasprintf_actual (const char *command, const char *func, const char *file, const int line, const char *name, char **strp, const char *fmt, va_list ap)
+{
+	int rc;
+	va_list aq;
+	va_copy(aq, ap);
+	rc = vsnprintf(NULL, 0, fmt, aq);
+	va_end(aq);
+	if (rc < 0) {
+		return rc;
+	}
+	*strp = malloc_actual(command, func, file, line, name, HMEMORY_KIND_MALLOC, rc + 1);
+	if (*strp == NULL) {
+		errno = ENOMEM;
+		return -1;
+	}
+	vsnprintf(*strp, rc + 1, fmt, ap);
 	return rc;
 }
 
-void HMEMORY_FUNCTION_NAME(free_actual) (const char *func, const char *file, const int line, void *address)
+void * HMEMORY_FUNCTION_NAME(memcpy_actual) (const char *func, const char *file, const int line, void *s1, const void *s2, size_t len)
 {
-	free_actual("free", func, file, line, address);
+	hprofile_scope(MEMCPY);
+	debug_memory_bounds(s1, len, "destination", "memcpy", func, file, line);
+	debug_memory_bounds(s2, len, "source", "memcpy", func, file, line);
+	debug_memory_overlap(s1, s2, len, "memcpy", func, file, line);
+	debug_copy_add(HMEMORY_COPY_MEMCPY, len, func, file, line);
+	return memcpy(s1, s2, len);
 }
 
-#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+void * HMEMORY_FUNCTION_NAME(memmove_actual) (const char *func, const char *file, const int line, void *s1, const void *s2, size_t len)
+{
+	hprofile_scope(MEMMOVE);
+	debug_memory_bounds(s1, len, "destination", "memmove", func, file, line);
+	debug_memory_bounds(s2, len, "source", "memmove", func, file, line);
+	debug_copy_add(HMEMORY_COPY_MEMMOVE, len, func, file, line);
+	return memmove(s1, s2, len);
+}
 
-static inline int hmemory_getenv_int (const char *name)
+void * HMEMORY_FUNCTION_NAME(memset_actual) (const char *func, const char *file, const int line, void *s, int c, size_t len)
 {
-	int r;
-	const char *e;
-	if (name == NULL) {
-		return -1;
-	}
-	e = getenv(name);
-	if (e == NULL) {
-		return -1;
-	}
-	r = atoi(e);
-	return r;
+	hprofile_scope(MEMSET);
+	debug_memory_bounds(s, len, "destination", "memset", func, file, line);
+	debug_copy_add(HMEMORY_COPY_MEMSET, len, func, file, line);
+	return memset(s, c, len);
 }
 
-static inline unsigned long long debug_getclock (void)
+char * HMEMORY_FUNCTION_NAME(strcpy_actual) (const char *func, const char *file, const int line, char *s1, const char *s2)
 {
-	struct timespec ts;
-	unsigned long long tsec;
-	unsigned long long tusec;
-	unsigned long long _clock;
-#if defined(__DARWIN__) && (__DARWIN__ == 1)
-	(void) ts;
-	(void) tsec;
-	(void) tusec;
-	_clock = mach_absolute_time();
-	_clock /= 1000 * 1000;
-#elif defined(__LINUX__) && (__LINUX__ == 1)
-	if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
-		return 0;
-	}
-	tsec = ((unsigned long long) ts.tv_sec) * 1000;
-	tusec = ((unsigned long long) ts.tv_nsec) / 1000 / 1000;
-	_clock = tsec + tusec;
-#else
-	#error "unknown os"
-#endif
-	return _clock;
+	size_t len;
+	hprofile_scope(STRCPY);
+	len = strlen(s2) + 1;
+	debug_memory_bounds(s1, len, "destination", "strcpy", func, file, line);
+	debug_memory_overlap(s1, s2, len, "strcpy", func, file, line);
+	debug_copy_add(HMEMORY_COPY_STRCPY, len, func, file, line);
+	return memcpy(s1, s2, len);
 }
 
-struct stackinfo {
-	const char *file;
-	const char *func;
-	unsigned int line;
-	void *func_addr;
-};
+char * HMEMORY_FUNCTION_NAME(strncpy_actual) (const char *func, const char *file, const int line, char *s1, const char *s2, size_t len)
+{
+	hprofile_scope(STRNCPY);
+	debug_memory_bounds(s1, len, "destination", "strncpy", func, file, line);
+	debug_memory_overlap(s1, s2, strnlen(s2, len), "strncpy", func, file, line);
+	debug_copy_add(HMEMORY_COPY_STRNCPY, len, func, file, line);
+	return strncpy(s1, s2, len);
+}
 
-static inline int debug_dump_callstack (const char *prefix)
+char * HMEMORY_FUNCTION_NAME(strcat_actual) (const char *func, const char *file, const int line, char *s1, const char *s2)
 {
-#if defined(HMEMORY_ENABLE_CALLSTACK) && (HMEMORY_ENABLE_CALLSTACK == 1)
-	#ifndef bfd_get_section_flags
-		#define bfd_get_section_flags(bfd, ptr) ((void) bfd, (ptr)->flags)
-		#define bfd_get_section_size(ptr) ((ptr)->size)
-		#define bfd_get_section_vma(bfd, ptr) ((void) bfd, (ptr)->vma)
-	#endif
+	size_t len;
+	char *end;
+	hprofile_scope(STRCAT);
+	end = s1 + strlen(s1);
+	len = strlen(s2) + 1;
+	debug_memory_bounds(end, len, "destination", "strcat", func, file, line);
+	debug_memory_overlap(end, s2, len, "strcat", func, file, line);
+	debug_copy_add(HMEMORY_COPY_STRCAT, len, func, file, line);
+	memcpy(end, s2, len);
+	return s1;
+}
 
-	int i;
+int HMEMORY_FUNCTION_NAME(snprintf_actual) (const char *func, const char *file, const int line, char *s, size_t len, const char *fmt, ...)
+{
 	int rc;
-	int size;
-	int frames;
-	char **strs;
-	bfd *bfd;
-	bfd_vma ofs;
-	bfd_vma start;
-	Dl_info dlinfo;
-	asymbol **syms;
-	asection *secp;
-	unsigned int v;
-	const char *fname;
-	const char *func;
-	unsigned int line;
-	struct stackinfo stackinfo;
-	void *callstack[HMEMORY_CALLSTACK_MAX];
-	v = hmemory_getenv_int(HMEMORY_REPORT_CALLSTACK_NAME);
-	if (v == (unsigned int) -1) {
-		v = HMEMORY_REPORT_CALLSTACK;
-	}
-	if (v == 0) {
+	va_list ap;
+	hprofile_scope(SNPRINTF);
+	debug_memory_bounds(s, len, "destination", "snprintf", func, file, line);
+	va_start(ap, fmt);
+	rc = vsnprintf(s, len, fmt, ap);
+	va_end(ap);
+	return rc;
+}
+
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+
+/*
+ * a line must stay representable in the ssize_t result, as with libc longer
+ * ones fail with EOVERFLOW. doubling stops short of that limit, and neither
+ * it nor the signatures realloc_actual adds can wrap the capacity.
+ */
+static inline int getdelim_reserve (const char *func, const char *file, const int line, const char *name, char **strp, size_t *n, size_t size)
+{
+	char *b;
+	size_t capacity;
+	capacity = (*strp == NULL) ? 0 : *n;
+	if (size <= capacity) {
 		return 0;
 	}
-	frames = backtrace(callstack, HMEMORY_CALLSTACK_MAX);
-	strs = backtrace_symbols(callstack, frames);
-	for (i = 1; i < frames; i++) {
-		if (dladdr(callstack[i], &dlinfo)) {
-			memset(&stackinfo, 0, sizeof(struct stackinfo));
-			stackinfo.func = dlinfo.dli_sname;
-			stackinfo.func_addr = dlinfo.dli_saddr;
-			bfd = bfd_openr(dlinfo.dli_fname, NULL);
-			if (bfd == NULL) {
-				continue;
-			}
-			rc = bfd_check_format(bfd, bfd_object);
-			if (rc == 0) {
-				bfd_close(bfd);
-				continue;
-			}
-			size = bfd_get_symtab_upper_bound(bfd);
-			if (size <= 0) {
-				bfd_close(bfd);
-				continue;
-			}
-			syms = malloc(size);
-			if (syms == NULL) {
-				bfd_close(bfd);
-				continue;
-			}
-			rc = bfd_canonicalize_symtab(bfd, syms);
-			if (rc <= 0) {
-				free(syms);
-				bfd_close(bfd);
-				continue;
+	if (size > SIZE_MAX / 2) {
+		errno = EOVERFLOW;
+		return -1;
+	}
+	if (capacity < 120) {
+		capacity = 120;
+	}
+	while (capacity < size) {
+		capacity = (capacity > SIZE_MAX / 4) ? size : capacity * 2;
+	}
+	b = HMEMORY_FUNCTION_NAME(realloc_actual)(func, file, line, name, *strp, capacity);
+	if (b == NULL) {
+		errno = ENOMEM;
+		return -1;
+	}
+	*strp = b;
+	*n = capacity;
+	return 0;
+}
+
+/*
+ * the caller's tracked buffer is reused across calls and grown
+ * geometrically with the tracked realloc, bytes are read straight into it.
+ * with glibc whole runs are copied out of the stream buffer, otherwise they
+ * are read one by one. the arguments are checked by the callers.
+ */
+static inline ssize_t getdelim_actual (const char *func, const char *file, const int line, const char *name, char **strp, size_t *n, int delim, FILE *stream)
+{
+	int c;
+	size_t length;
+#if defined(__GLIBC__)
+	char *p;
+	size_t chunk;
+#endif
+	length = 0;
+	flockfile(stream);
+	while (1) {
+#if defined(__GLIBC__)
+		if (stream->_IO_read_ptr < stream->_IO_read_end) {
+			chunk = stream->_IO_read_end - stream->_IO_read_ptr;
+			p = memchr(stream->_IO_read_ptr, delim, chunk);
+			if (p != NULL) {
+				chunk = p - stream->_IO_read_ptr + 1;
 			}
-			#define ELF_DYNAMIC	0x40
-			if (bfd->flags & ELF_DYNAMIC) {
-				ofs = callstack[i] - dlinfo.dli_fbase;
-			} else {
-				ofs = callstack[i] - (void *) 0;
+			if (getdelim_reserve(func, file, line, name, strp, n, length + chunk + 1) != 0) {
+				funlockfile(stream);
+				return -1;
 			}
-			for (secp = bfd->sections; secp != NULL; secp = secp->next) {
-				if (!(bfd_get_section_flags(bfd, secp) & SEC_ALLOC)) {
-					continue;
-				}
-				start = bfd_get_section_vma(bfd, secp);
-				if (ofs < start) {
-					continue;
-				}
-				size = bfd_get_section_size(secp);
-				if (ofs >= start + size) {
-					continue;
-				}
-				if (bfd_find_nearest_line(bfd, secp, syms, ofs - start, &fname, &func, &line)) {
-					stackinfo.file = fname;
-					if (func != NULL) {
-						stackinfo.func = func;
-					}
-					stackinfo.line = line;
-					if (!stackinfo.func_addr && stackinfo.func) {
-						asymbol **asymp;
-						for (asymp = syms; *asymp; asymp++) {
-							if (strcmp(bfd_asymbol_name(*asymp), stackinfo.func) == 0) {
-								stackinfo.func_addr = bfd_asymbol_value (*asymp) + (void *) 0;
-								break;
-							}
-						}
-					}
-				}
-
+			memcpy(*strp + length, stream->_IO_read_ptr, chunk);
+			stream->_IO_read_ptr += chunk;
+			length += chunk;
+			if (p != NULL) {
 				break;
 			}
-			hinfof("%s%p: %s (%s:%d)", prefix, callstack[i], (stackinfo.file == NULL) ? "(null)" : ((strrchr(stackinfo.file, '/') == NULL) ? stackinfo.file : (strrchr(stackinfo.file, '/') + 1)), stackinfo.func, stackinfo.line);
-			free(syms);
-			bfd_close(bfd);
+			continue;
+		}
+#endif
+		c = getc_unlocked(stream);
+		if (c == EOF) {
+			break;
+		}
+		if (getdelim_reserve(func, file, line, name, strp, n, length + 2) != 0) {
+			funlockfile(stream);
+			return -1;
+		}
+		(*strp)[length++] = c;
+		if (c == delim) {
+			break;
 		}
 	}
-#if 0
-	for (i = 0; i < frames; i++) {
-		hinfof("%s%s", prefix, strs[i]);
+	funlockfile(stream);
+	if (length == 0) {
+		return -1;
 	}
+	(*strp)[length] = '\0';
+	return length;
+}
+
 #endif
-	free(strs);
+
+ssize_t HMEMORY_FUNCTION_NAME(getline_actual) (const char *func, const char *file, const int line, const char *name, char **strp, size_t *n, FILE *stream)
+{
+	ssize_t rc;
+	hprofile_scope(GETLINE);
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	if (strp == NULL || n == NULL || stream == NULL) {
+		hdebug_lock();
+		hinfof("getline with invalid arguments (strp: %p, n: %p, stream: %p)", (void *) strp, (void *) n, (void *) stream);
+		hinfof("    at: %s %s:%d", func, file, line);
+		debug_dump_callstack("       ");
+		hdebug_unlock();
+		hassert(0 && "getline invalid arguments");
+		errno = EINVAL;
+		return -1;
+	}
+	rc = getdelim_actual(func, file, line, name, strp, n, '\n', stream);
 #else
-	(void) prefix;
+	(void) name;
+	(void) func;
+	(void) file;
+	(void) line;
+	hprofile_phase(ALLOCATOR, rc = getline(strp, n, stream));
 #endif
-	return 0;
+	return rc;
 }
 
-#if !defined(MAX)
-#define MAX(a, b)				(((a) > (b)) ? (a) : (b))
-#endif
-
-#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-#define hmemory_int64_hash_func(key) (khint32_t)(((uint64_t) key)>>33^((uint64_t) key)^((uint64_t) key)<<11)
-KHASH_INIT(memory, void *, struct hmemory_memory *, 1, hmemory_int64_hash_func, kh_int64_hash_equal);
+ssize_t HMEMORY_FUNCTION_NAME(getdelim_actual) (const char *func, const char *file, const int line, const char *name, char **strp, size_t *n, int delim, FILE *stream)
+{
+	ssize_t rc;
+	hprofile_scope(GETDELIM);
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	if (strp == NULL || n == NULL || stream == NULL) {
+		hdebug_lock();
+		hinfof("getdelim with invalid arguments (strp: %p, n: %p, stream: %p)", (void *) strp, (void *) n, (void *) stream);
+		hinfof("    at: %s %s:%d", func, file, line);
+		debug_dump_callstack("       ");
+		hdebug_unlock();
+		hassert(0 && "getdelim invalid arguments");
+		errno = EINVAL;
+		return -1;
+	}
+	rc = getdelim_actual(func, file, line, name, strp, n, delim, stream);
+#else
+	(void) name;
+	(void) func;
+	(void) file;
+	(void) line;
+	hprofile_phase(ALLOCATOR, rc = getdelim(strp, n, delim, stream));
 #endif
+	return rc;
+}
 
+int HMEMORY_FUNCTION_NAME(asprintf_actual) (const char *func, const char *file, const int line, const char *name, char **strp, const char *fmt, ...)
+{
+	int rc;
+	va_list ap;
+	hprofile_scope(ASPRINTF);
+	va_start(ap, fmt);
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	rc = vasprintf_actual("asprintf", func, file, line, name, strp, fmt, ap);
+	if (rc < 0) {
+		hdebug_lock();
+		hinfof("asprintf failed");
+		hinfof("    at: %s %s:%d", func, file, line);
+		debug_dump_callstack("       ");
+		hdebug_unlock();
+		hassert((rc >= 0) && "asprintf failed");
+	}
+#else
+	(void) name;
+	(void) func;
+	(void) file;
+	(void) line;
+	hprofile_phase(ALLOCATOR, rc = vasprintf(strp, fmt, ap));
+#endif
+	va_end(ap);
+	return rc;
+}
+
+int HMEMORY_FUNCTION_NAME(vasprintf_actual) (const char *func, const char *file, const int line, const char *name, char **strp, const char *fmt, va_list ap)
+{
+	int rc;
+	hprofile_scope(VASPRINTF);
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	rc = vasprintf_actual("vasprintf", func, file, line, name, strp, fmt, ap);
+	if (rc < 0) {
+		hdebug_lock();
+		hinfof("vasprintf failed");
+		hinfof("    at: %s %s:%d", func, file, line);
+		debug_dump_callstack("       ");
+		hdebug_unlock();
+		hassert((rc >= 0) && "vasprintf failed");
+	}
+#else
+	(void) name;
+	(void) func;
+	(void) file;
+	(void) line;
+	hprofile_phase(ALLOCATOR, rc = vasprintf(strp, fmt, ap));
+#endif
+	return rc;
+}
+
+char * HMEMORY_FUNCTION_NAME(strdup_actual) (const char *func, const char *file, const int line, const char *name, const char *string)
+{
+	void *rc;
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	size_t length;
+#endif
+	hprofile_scope(STRDUP);
+	if (string == NULL) {
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+		hdebug_lock();
+		hinfof("strdup with invalid argument '%p'", string);
+		hinfof("    at: %s %s:%d", func, file, line);
+		debug_dump_callstack("       ");
+		hdebug_unlock();
+		hassert((string != NULL) && "invalid strdup parameter");
+#endif
+		return NULL;
+	}
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	length = strlen(string);
+	rc = malloc_actual("strdup", func, file, line, name, HMEMORY_KIND_MALLOC, length + 1);
+	if (rc != NULL) {
+		memcpy(rc, string, length + 1);
+	}
+#else
+	(void) name;
+	(void) func;
+	(void) file;
+	(void) line;
+	hprofile_phase(ALLOCATOR, rc = strdup(string));
+#endif
+	if (rc == NULL) {
+		herrorf("strdup failed");
+	}
+	return rc;
+}
+
+char * HMEMORY_FUNCTION_NAME(strndup_actual) (const char *func, const char *file, const int line, const char *name, const char *string, size_t size)
+{
+	void *rc;
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	size_t length;
+#endif
+	hprofile_scope(STRNDUP);
+	if (string == NULL) {
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+		hdebug_lock();
+		hinfof("strdup with invalid argument '%p'", string);
+		hinfof("    at: %s %s:%d", func, file, line);
+		debug_dump_callstack("       ");
+		hdebug_unlock();
+		hassert((string != NULL) && "invalid strndup parameter");
+#endif
+		return NULL;
+	}
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	length = strnlen(string, size);
+	rc = malloc_actual("strndup", func, file, line, name, HMEMORY_KIND_MALLOC, length + 1);
+	if (rc != NULL) {
+		memcpy(rc, string, length);
+		((char *) rc)[length] = '\0';
+	}
+#else
+	(void) name;
+	(void) func;
+	(void) file;
+	(void) line;
+	hprofile_phase(ALLOCATOR, rc = strndup(string, size));
+#endif
+	if (rc == NULL) {
+		herrorf("strndup failed");
+	}
+	return rc;
+}
+
+void * HMEMORY_FUNCTION_NAME(malloc_actual) (const char *func, const char *file, const int line, const char *name, size_t size)
+{
+	void *rc;
+	hprofile_scope(MALLOC);
+	rc = malloc_actual("malloc", func, file, line, name, HMEMORY_KIND_MALLOC, size);
+	if (rc == NULL) {
+		herrorf("malloc_actual failed");
+		return NULL;
+	}
+	return rc;
+}
+
+void * HMEMORY_FUNCTION_NAME(calloc_actual) (const char *func, const char *file, const int line, const char *name, size_t nmemb, size_t size)
+{
+	void *rc;
+	hprofile_scope(CALLOC);
+	rc = calloc_actual("calloc", func, file, line, name, nmemb, size);
+	if (rc == NULL) {
+		herrorf("calloc_actual failed");
+		return NULL;
+	}
+	return rc;
+}
+
+void * HMEMORY_FUNCTION_NAME(realloc_actual) (const char *func, const char *file, const int line, const char *name, void *address, size_t size)
+{
+	void *rc;
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	int large;
+	void *addr;
+	void *base;
+	size_t osize;
+	struct hmemory_memory *m;
+#endif
+	hprofile_scope(REALLOC);
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	if (address == NULL) {
+		rc = malloc_actual("realloc", func, file, line, name, HMEMORY_KIND_MALLOC, size);
+		if (rc == NULL) {
+			herrorf("malloc_actual failed");
+			return NULL;
+		}
+		return rc;
+	}
+	if (debug_size_overflow(size, 0)) {
+		herrorf("realloc overflow");
+		errno = ENOMEM;
+		return NULL;
+	}
+	large = debug_large_wanted(size);
+	size += hmemory_signature_size * 2;
+	addr = address - hmemory_signature_size;
+	m = debug_memory_acquire(addr, HMEMORY_KIND_MALLOC, &base, &osize, "realloc", func, file, line);
+	if (m == NULL) {
+		if (debug_arena_untracked(addr, NULL, &osize, NULL) == 0) {
+			return NULL;
+		}
+		rc = malloc_actual("realloc", func, file, line, name, HMEMORY_KIND_MALLOC, size - (hmemory_signature_size * 2));
+		if (rc == NULL) {
+			herrorf("malloc_actual failed");
+			return NULL;
+		}
+		memcpy(rc, address, ((osize < size) ? osize : size) - (hmemory_signature_size * 2));
+		free_actual("realloc", func, file, line, HMEMORY_KIND_MALLOC, 0, address);
+		return rc;
+	}
+	if (debug_memory_large(m) && large) {
+		hprofile_phase(ALLOCATOR, rc = debug_large_remap(m, size));
+		if (rc == NULL) {
+			hmemory_unlock();
+			herrorf("mremap failed");
+			return NULL;
+		}
+	} else if (debug_memory_large(m) || large || base != addr - (hmemory_head_size - hmemory_signature_size)) {
+		hmemory_unlock();
+		rc = malloc_actual("realloc", func, file, line, name, HMEMORY_KIND_MALLOC, size - (hmemory_signature_size * 2));
+		if (rc == NULL) {
+			herrorf("malloc_actual failed");
+			return NULL;
+		}
+		memcpy(rc, address, ((osize < size) ? osize : size) - (hmemory_signature_size * 2));
+		free_actual("realloc", func, file, line, HMEMORY_KIND_MALLOC, 0, address);
+		return rc;
+	} else {
+		hprofile_phase(ALLOCATOR, rc = realloc(base, hmemory_head_size - hmemory_signature_size + size));
+		if (rc == NULL) {
+			hmemory_unlock();
+			herrorf("realloc failed");
+			return NULL;
+		}
+	}
+	addr = rc + hmemory_head_size - hmemory_signature_size;
+	if (debug_memory_resize(m, rc, addr, size, func, file, line) != 0) {
+		herrorf("realloc tracking failed");
+		errno = ENOMEM;
+		return NULL;
+	}
+	return addr + hmemory_signature_size;
+#else
+	(void) name;
+	(void) func;
+	(void) file;
+	(void) line;
+	rc = realloc(address, size);
+	if (rc == NULL) {
+		herrorf("realloc failed");
+		return NULL;
+	}
+#endif
+	return rc;
+}
+
+void HMEMORY_FUNCTION_NAME(free_actual) (const char *func, const char *file, const int line, void *address)
+{
+	hprofile_scope(FREE);
+	free_actual("free", func, file, line, HMEMORY_KIND_MALLOC, 0, address);
+}
+
+void * HMEMORY_FUNCTION_NAME(reallocarray_actual) (const char *func, const char *file, const int line, const char *name, void *address, size_t nmemb, size_t size)
+{
+	size_t total;
+	if (__builtin_mul_overflow(nmemb, size, &total)) {
+		herrorf("reallocarray overflow");
+		errno = ENOMEM;
+		return NULL;
+	}
+	return HMEMORY_FUNCTION_NAME(realloc_actual)(func, file, line, name, address, total);
+}
+
+int HMEMORY_FUNCTION_NAME(posix_memalign_actual) (const char *func, const char *file, const int line, const char *name, void **memptr, size_t alignment, size_t size)
+{
+	void *rc;
+	hprofile_scope(MEMALIGN);
+	if (!debug_power_of_two(alignment) || (alignment % sizeof(void *)) != 0) {
+		return EINVAL;
+	}
+	rc = memalign_actual("posix_memalign", func, file, line, name, HMEMORY_KIND_MALLOC, alignment, size);
+	if (rc == NULL) {
+		return ENOMEM;
+	}
+	*memptr = rc;
+	return 0;
+}
+
+void * HMEMORY_FUNCTION_NAME(aligned_alloc_actual) (const char *func, const char *file, const int line, const char *name, size_t alignment, size_t size)
+{
+	void *rc;
+	hprofile_scope(MEMALIGN);
+	if (!debug_power_of_two(alignment)) {
+		errno = EINVAL;
+		return NULL;
+	}
+	rc = memalign_actual("aligned_alloc", func, file, line, name, HMEMORY_KIND_MALLOC, alignment, size);
+	if (rc == NULL) {
+		errno = ENOMEM;
+	}
+	return rc;
+}
+
+void * HMEMORY_FUNCTION_NAME(memalign_actual) (const char *func, const char *file, const int line, const char *name, size_t alignment, size_t size)
+{
+	void *rc;
+	size_t power;
+	hprofile_scope(MEMALIGN);
+	power = debug_alignment_round(alignment);
+	if (power == 0) {
+		errno = EINVAL;
+		return NULL;
+	}
+	rc = memalign_actual("memalign", func, file, line, name, HMEMORY_KIND_MALLOC, power, size);
+	if (rc == NULL) {
+		errno = ENOMEM;
+	}
+	return rc;
+}
+
+void * HMEMORY_FUNCTION_NAME(valloc_actual) (const char *func, const char *file, const int line, const char *name, size_t size)
+{
+	void *rc;
+	hprofile_scope(MEMALIGN);
+	rc = memalign_actual("valloc", func, file, line, name, HMEMORY_KIND_MALLOC, sysconf(_SC_PAGESIZE), size);
+	if (rc == NULL) {
+		errno = ENOMEM;
+	}
+	return rc;
+}
+
+void * HMEMORY_FUNCTION_NAME(pvalloc_actual) (const char *func, const char *file, const int line, const char *name, size_t size)
+{
+	void *rc;
+	size_t page;
+	hprofile_scope(MEMALIGN);
+	page = sysconf(_SC_PAGESIZE);
+	if (debug_page_round(&size, page) != 0) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	rc = memalign_actual("pvalloc", func, file, line, name, HMEMORY_KIND_MALLOC, page, size);
+	if (rc == NULL) {
+		errno = ENOMEM;
+	}
+	return rc;
+}
+
+size_t HMEMORY_FUNCTION_NAME(malloc_usable_size_actual) (const char *func, const char *file, const int line, void *address)
+{
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	size_t size;
+#endif
+	if (address == NULL) {
+		return 0;
+	}
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	if (debug_memory_find(address - hmemory_signature_size, NULL, &size, NULL) != 0) {
+		debug_memory_check(address - hmemory_signature_size, "malloc_usable_size", func, file, line);
+		return 0;
+	}
+	return size - (hmemory_signature_size * 2);
+#else
+	(void) func;
+	(void) file;
+	(void) line;
+	return malloc_usable_size(address);
+#endif
+}
+
+void * HMEMORY_FUNCTION_NAME(new_actual) (const char *func, const char *file, const int line, const char *name, int array, size_t alignment, size_t size)
+{
+	hprofile_scope(NEW);
+	return memalign_actual((array) ? "new[]" : "new", func, file, line, name, (array) ? HMEMORY_KIND_NEW_ARRAY : HMEMORY_KIND_NEW, alignment, size);
+}
+
+/*
+ * sized delete passes its size down to debug_memory_del, which compares it
+ * with the size of the record it removes, in the same lookup.
+ */
+void HMEMORY_FUNCTION_NAME(delete_actual) (const char *func, const char *file, const int line, int array, size_t size, void *address)
+{
+	const char *command;
+	hprofile_scope(DELETE);
+	command = (array) ? "delete[]" : "delete";
+	if (address == NULL) {
+		return;
+	}
+	free_actual(command, func, file, line, (array) ? HMEMORY_KIND_NEW_ARRAY : HMEMORY_KIND_NEW, size, address);
+}
+
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+
+struct hmemory_config_option {
+	const char *name;
+	size_t offset;
+	size_t size;
+};
+
+#define HMEMORY_CONFIG_INT(n, f)	{ n, offsetof(struct hmemory_config, f), 0 }
+#define HMEMORY_CONFIG_STRING(n, f)	{ n, offsetof(struct hmemory_config, f), sizeof(((struct hmemory_config *) 0)->f) }
+
+static const struct hmemory_config_option hmemory_config_options[] = {
+	HMEMORY_CONFIG_INT(HMEMORY_ASSERT_ON_ERROR_NAME, assert_on_error),
+	HMEMORY_CONFIG_INT(HMEMORY_REPORT_CALLSTACK_NAME, report_callstack),
+	HMEMORY_CONFIG_INT(HMEMORY_CHECK_INTERVAL_NAME, check_interval),
+	HMEMORY_CONFIG_INT(HMEMORY_SHOW_REACHABLE_NAME, show_reachable),
+	HMEMORY_CONFIG_INT(HMEMORY_REPORT_HISTOGRAM_NAME, report_histogram),
+	HMEMORY_CONFIG_INT(HMEMORY_REPORT_COPY_NAME, report_copy),
+	HMEMORY_CONFIG_INT(HMEMORY_LEAK_CHECK_NAME, leak_check),
+	HMEMORY_CONFIG_INT(HMEMORY_LEAK_THREADS_NAME, leak_threads),
+	HMEMORY_CONFIG_INT(HMEMORY_LEAK_TOP_NAME, leak_top),
+	HMEMORY_CONFIG_INT(HMEMORY_FAST_EXIT_NAME, fast_exit),
+	HMEMORY_CONFIG_INT(HMEMORY_LEAK_INTERVAL_NAME, leak_interval),
+	HMEMORY_CONFIG_INT(HMEMORY_LEAK_SIGNAL_NAME, leak_signal),
+	HMEMORY_CONFIG_INT(HMEMORY_FORK_STATISTICS_NAME, fork_statistics),
+	HMEMORY_CONFIG_INT(HMEMORY_LARGE_THRESHOLD_NAME, large_threshold),
+	HMEMORY_CONFIG_INT(HMEMORY_TABLE_CAPACITY_NAME, table_capacity),
+	HMEMORY_CONFIG_INT(HMEMORY_METADATA_REGION_NAME, metadata_region),
+	HMEMORY_CONFIG_STRING(HMEMORY_HISTOGRAM_FILE_NAME, histogram_file),
+	HMEMORY_CONFIG_STRING(HMEMORY_SUPPRESSIONS_NAME, suppressions),
+};
+
+static volatile sig_atomic_t hmemory_config_requested;
+static struct stat hmemory_config_stat;
+
+/*
+ * -1 keeps the default, as an unset variable always did.
+ */
+static int debug_config_set (struct hmemory_config *config, const char *name, const char *value)
+{
+	int v;
+	size_t i;
+	const struct hmemory_config_option *o;
+	for (i = 0; i < sizeof(hmemory_config_options) / sizeof(hmemory_config_options[0]); i++) {
+		o = &hmemory_config_options[i];
+		if (strcmp(o->name, name) != 0) {
+			continue;
+		}
+		if (o->size == 0) {
+			v = atoi(value);
+			if (v != -1) {
+				*(int *) (((char *) config) + o->offset) = v;
+			}
+		} else {
+			snprintf(((char *) config) + o->offset, o->size, "%s", value);
+		}
+		return 0;
+	}
+	return -1;
+}
+
+static int debug_config_file (struct hmemory_config *config, const char *path)
+{
+	int n;
+	FILE *fp;
+	char *p;
+	char *e;
+	char *v;
+	char line[1024];
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		herrorf("can not open config file %s", path);
+		return -1;
+	}
+	for (n = 1; fgets(line, sizeof(line), fp) != NULL; n++) {
+		p = line + strspn(line, " \t");
+		e = p + strcspn(p, "\r\n");
+		while (e > p && (e[-1] == ' ' || e[-1] == '\t')) {
+			e--;
+		}
+		*e = '\0';
+		if (*p == '\0' || *p == '#') {
+			continue;
+		}
+		v = strchr(p, '=');
+		if (v == NULL) {
+			herrorf("invalid setting at %s:%d", path, n);
+			continue;
+		}
+		for (e = v; e > p && (e[-1] == ' ' || e[-1] == '\t'); e--) {
+		}
+		*e = '\0';
+		v += 1;
+		v += strspn(v, " \t");
+		if (debug_config_set(config, p, v) != 0) {
+			herrorf("unknown setting %s at %s:%d", p, path, n);
+		}
+	}
+	fclose(fp);
+	return 0;
+}
+
+/*
+ * builds a snapshot from the defaults, the environment and the config file,
+ * in that order, and publishes it. the path of the config file is taken
+ * from the environment on the first load and carried over by reloads.
+ */
+static int debug_config_load (void)
+{
+	size_t i;
+	const char *e;
+	struct hmemory_config *config;
+	config = malloc(sizeof(struct hmemory_config));
+	if (config == NULL) {
+		return -1;
+	}
+	memcpy(config, &hmemory_config_defaults, sizeof(struct hmemory_config));
+	for (i = 0; i < sizeof(hmemory_config_options) / sizeof(hmemory_config_options[0]); i++) {
+		e = getenv(hmemory_config_options[i].name);
+		if (e != NULL) {
+			debug_config_set(config, hmemory_config_options[i].name, e);
+		}
+	}
+	if (hmemory_config == &hmemory_config_defaults) {
+		e = getenv(HMEMORY_CONFIG_FILE_NAME);
+		snprintf(config->config_file, sizeof(config->config_file), "%s", (e == NULL) ? "" : e);
+	} else {
+		memcpy(config->config_file, hmemory_config->config_file, sizeof(config->config_file));
+	}
+	if (config->config_file[0] != '\0') {
+		if (stat(config->config_file, &hmemory_config_stat) != 0) {
+			memset(&hmemory_config_stat, 0, sizeof(hmemory_config_stat));
+		}
+		debug_config_file(config, config->config_file);
+	}
+	config->previous = hmemory_config;
+	__atomic_store_n(&hmemory_config, config, __ATOMIC_RELEASE);
+	return 0;
+}
+
+static void debug_config_signal (int signum)
+{
+	(void) signum;
+	hmemory_config_requested = 1;
+}
+
+/*
+ * called from the worker, reloads on SIGHUP or when the config file has
+ * been modified.
+ */
+static void debug_config_reload (void)
+{
+	const char *e;
+	struct stat st;
+	e = hconfig(config_file);
+	if (*e == '\0') {
+		return;
+	}
+	if (hmemory_config_requested == 0) {
+		if (stat(e, &st) != 0 ||
+		    (st.st_mtim.tv_sec == hmemory_config_stat.st_mtim.tv_sec &&
+		     st.st_mtim.tv_nsec == hmemory_config_stat.st_mtim.tv_nsec &&
+		     st.st_size == hmemory_config_stat.st_size &&
+		     st.st_ino == hmemory_config_stat.st_ino)) {
+			return;
+		}
+	}
+	hmemory_config_requested = 0;
+	if (debug_config_load() == 0) {
+		hinfof("configuration reloaded from %s", e);
+	}
+}
+
+#if !defined(HMEMORY_PRELOAD) || (HMEMORY_PRELOAD == 0)
+
+static void debug_config_fini (void)
+{
+	struct hmemory_config *c;
+	struct hmemory_config *p;
+	c = __atomic_exchange_n(&hmemory_config, &hmemory_config_defaults, __ATOMIC_ACQ_REL);
+	for (; c != &hmemory_config_defaults; c = p) {
+		p = c->previous;
+		free(c);
+	}
+}
+
+#endif
+
+static inline unsigned long long debug_getclock (void)
+{
+	struct timespec ts;
+	unsigned long long tsec;
+	unsigned long long tusec;
+	unsigned long long _clock;
+#if defined(__DARWIN__) && (__DARWIN__ == 1)
+	(void) ts;
+	(void) tsec;
+	(void) tusec;
+	_clock = mach_absolute_time();
+	_clock /= 1000 * 1000;
+#elif defined(__LINUX__) && (__LINUX__ == 1)
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+		return 0;
+	}
+	tsec = ((unsigned long long) ts.tv_sec) * 1000;
+	tusec = ((unsigned long long) ts.tv_nsec) / 1000 / 1000;
+	_clock = tsec + tusec;
+#else
+	#error "unknown os"
+#endif
+	return _clock;
+}
+
+static inline unsigned long long debug_getclock_ns (void)
+{
+	unsigned long long _clock;
+#if defined(__DARWIN__) && (__DARWIN__ == 1)
+	static mach_timebase_info_data_t tb;
+	if (tb.denom == 0) {
+		mach_timebase_info(&tb);
+	}
+	_clock = mach_absolute_time() * tb.numer / tb.denom;
+#elif defined(__LINUX__) && (__LINUX__ == 1)
+	struct timespec ts;
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+		return 0;
+	}
+	_clock = ((unsigned long long) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#else
+	#error "unknown os"
+#endif
+	return _clock;
+}
+
+struct stackinfo {
+	const char *file;
+	const char *func;
+	unsigned int line;
+	void *func_addr;
+};
+
+static inline int debug_dump_callstack (const char *prefix)
+{
+#if defined(HMEMORY_ENABLE_CALLSTACK) && (HMEMORY_ENABLE_CALLSTACK == 1)
+	#ifndef bfd_get_section_flags
+		#define bfd_get_section_flags(bfd, ptr) ((void) bfd, (ptr)->flags)
+		#define bfd_get_section_size(ptr) ((ptr)->size)
+		#define bfd_get_section_vma(bfd, ptr) ((void) bfd, (ptr)->vma)
+	#endif
+
+	int i;
+	int rc;
+	int size;
+	int frames;
+	char **strs;
+	bfd *bfd;
+	bfd_vma ofs;
+	bfd_vma start;
+	Dl_info dlinfo;
+	asymbol **syms;
+	asection *secp;
+	unsigned int v;
+	const char *fname;
+	const char *func;
+	unsigned int line;
+	struct stackinfo stackinfo;
+	void *callstack[HMEMORY_CALLSTACK_MAX];
+	v = hconfig(report_callstack);
+	if (v == 0) {
+		return 0;
+	}
+	frames = backtrace(callstack, HMEMORY_CALLSTACK_MAX);
+	strs = backtrace_symbols(callstack, frames);
+	for (i = 1; i < frames; i++) {
+		if (dladdr(callstack[i], &dlinfo)) {
+			memset(&stackinfo, 0, sizeof(struct stackinfo));
+			stackinfo.func = dlinfo.dli_sname;
+			stackinfo.func_addr = dlinfo.dli_saddr;
+			bfd = bfd_openr(dlinfo.dli_fname, NULL);
+			if (bfd == NULL) {
+				continue;
+			}
+			rc = bfd_check_format(bfd, bfd_object);
+			if (rc == 0) {
+				bfd_close(bfd);
+				continue;
+			}
+			size = bfd_get_symtab_upper_bound(bfd);
+			if (size <= 0) {
+				bfd_close(bfd);
+				continue;
+			}
+			syms = malloc(size);
+			if (syms == NULL) {
+				bfd_close(bfd);
+				continue;
+			}
+			rc = bfd_canonicalize_symtab(bfd, syms);
+			if (rc <= 0) {
+				free(syms);
+				bfd_close(bfd);
+				continue;
+			}
+			#define ELF_DYNAMIC	0x40
+			if (bfd->flags & ELF_DYNAMIC) {
+				ofs = callstack[i] - dlinfo.dli_fbase;
+			} else {
+				ofs = callstack[i] - (void *) 0;
+			}
+			for (secp = bfd->sections; secp != NULL; secp = secp->next) {
+				if (!(bfd_get_section_flags(bfd, secp) & SEC_ALLOC)) {
+					continue;
+				}
+				start = bfd_get_section_vma(bfd, secp);
+				if (ofs < start) {
+					continue;
+				}
+				size = bfd_get_section_size(secp);
+				if (ofs >= start + size) {
+					continue;
+				}
+				if (bfd_find_nearest_line(bfd, secp, syms, ofs - start, &fname, &func, &line)) {
+					stackinfo.file = fname;
+					if (func != NULL) {
+						stackinfo.func = func;
+					}
+					stackinfo.line = line;
+					if (!stackinfo.func_addr && stackinfo.func) {
+						asymbol **asymp;
+						for (asymp = syms; *asymp; asymp++) {
+							if (strcmp(bfd_asymbol_name(*asymp), stackinfo.func) == 0) {
+								stackinfo.func_addr = bfd_asymbol_value (*asymp) + (void *) 0;
+								break;
+							}
+						}
+					}
+				}
+
+				break;
+			}
+			hinfof("%s%p: %s (%s:%d)", prefix, callstack[i], (stackinfo.file == NULL) ? "(null)" : ((strrchr(stackinfo.file, '/') == NULL) ? stackinfo.file : (strrchr(stackinfo.file, '/') + 1)), stackinfo.func, stackinfo.line);
+			free(syms);
+			bfd_close(bfd);
+		}
+	}
+#if 0
+	for (i = 0; i < frames; i++) {
+		hinfof("%s%s", prefix, strs[i]);
+	}
+#endif
+	free(strs);
+#else
+	(void) prefix;
+#endif
+	return 0;
+}
+
+#if !defined(MAX)
+#define MAX(a, b)				(((a) > (b)) ? (a) : (b))
+#endif
+
+#define hmemory_int64_hash_func(key) (khint32_t)(((uint64_t) key)>>33^((uint64_t) key)^((uint64_t) key)<<11)
+
+/*
+ * tracking tables, khash tables that grow incrementally. when a table is
+ * full, a table of twice the size (or the same size, when most of the
+ * occupied buckets are deleted entries) is allocated and the old one is
+ * kept around. every later insert and delete moves HMEMORY_TABLE_STEP
+ * buckets of the old table into the new one, so a single call never pays
+ * for rehashing the whole table. lookups check the new table first, and the
+ * old one while it is not drained. the new table has room for the old
+ * entries plus the inserts made while draining, so khash never resizes it
+ * on its own.
+ */
+#define HMEMORY_TABLE_STEP			16
+
+#define hmemory_table_t(name)			struct hmemory_table_##name
+
+#define debug_table_size(t)			(kh_size((t)->table) + (((t)->old != NULL) ? kh_size((t)->old) : 0))
+
+#define debug_table_foreach(t, vvar, code) {						\
+	if ((t)->old != NULL) {								\
+		kh_foreach_value((t)->old, vvar, code)					\
+	}										\
+	kh_foreach_value((t)->table, vvar, code)					\
+}
+
+#define HMEMORY_TABLE_INIT(name, khkey_t, khval_t)					\
+	hmemory_table_t(name) {								\
+		khash_t(name) *table;							\
+		khash_t(name) *old;							\
+		khint_t cursor;								\
+	};										\
+											\
+	static inline int debug_table_init_##name (hmemory_table_t(name) *t, size_t capacity)	\
+	{										\
+		t->old = NULL;								\
+		t->cursor = 0;								\
+		t->table = kh_init(name);						\
+		if (t->table == NULL) {							\
+			return -1;							\
+		}									\
+		if (capacity == 0) {							\
+			return 0;							\
+		}									\
+		capacity = (size_t) (capacity / __ac_HASH_UPPER) + 1;			\
+		return kh_resize(name, t->table, (khint_t) capacity);			\
+	}										\
+											\
+	static inline void debug_table_destroy_##name (hmemory_table_t(name) *t)		\
+	{										\
+		kh_destroy(name, t->old);						\
+		kh_destroy(name, t->table);						\
+		t->old = NULL;								\
+		t->table = NULL;							\
+	}										\
+											\
+	static inline void debug_table_step_##name (hmemory_table_t(name) *t, khint_t count)	\
+	{										\
+		int ret;								\
+		khiter_t k;								\
+		khint_t end;								\
+		if (t->old == NULL) {							\
+			return;								\
+		}									\
+		end = kh_end(t->old);							\
+		for (; t->cursor < end && count > 0; t->cursor++, count--) {		\
+			if (!kh_exist(t->old, t->cursor)) {				\
+				continue;						\
+			}								\
+			k = kh_put(name, t->table, kh_key(t->old, t->cursor), &ret);	\
+			if (ret == -1) {						\
+				return;							\
+			}								\
+			kh_value(t->table, k) = kh_value(t->old, t->cursor);		\
+			kh_del(name, t->old, t->cursor);				\
+		}									\
+		if (t->cursor >= end) {							\
+			kh_destroy(name, t->old);					\
+			t->old = NULL;							\
+			t->cursor = 0;							\
+		}									\
+	}										\
+											\
+	static inline void debug_table_grow_##name (hmemory_table_t(name) *t)		\
+	{										\
+		khint_t size;								\
+		khash_t(name) *table;							\
+		if (t->table->n_occupied < t->table->upper_bound) {			\
+			return;								\
+		}									\
+		if (t->old != NULL) {							\
+			debug_table_step_##name(t, ~0U);				\
+			if (t->old != NULL) {						\
+				return;							\
+			}								\
+		}									\
+		size = (t->table->n_buckets < 4) ? 4 : t->table->n_buckets;		\
+		if (kh_size(t->table) * 2 >= t->table->upper_bound) {			\
+			size *= 2;							\
+		}									\
+		table = kh_init(name);							\
+		if (table == NULL) {							\
+			return;								\
+		}									\
+		if (kh_resize(name, table, size) != 0) {				\
+			kh_destroy(name, table);					\
+			return;								\
+		}									\
+		t->old = t->table;							\
+		t->table = table;							\
+		t->cursor = 0;								\
+	}										\
+											\
+	static inline khval_t * debug_table_get_##name (hmemory_table_t(name) *t, khkey_t key)	\
+	{										\
+		khiter_t k;								\
+		k = kh_get(name, t->table, key);					\
+		if (k != kh_end(t->table)) {						\
+			return &kh_value(t->table, k);					\
+		}									\
+		if (t->old != NULL) {							\
+			k = kh_get(name, t->old, key);					\
+			if (k != kh_end(t->old)) {					\
+				return &kh_value(t->old, k);				\
+			}								\
+		}									\
+		return NULL;								\
+	}										\
+											\
+	static inline khval_t * debug_table_put_##name (hmemory_table_t(name) *t, khkey_t key, int *ret)	\
+	{										\
+		khiter_t k;								\
+		if (t->old != NULL) {							\
+			k = kh_get(name, t->old, key);					\
+			if (k != kh_end(t->old)) {					\
+				*ret = 0;						\
+				return &kh_value(t->old, k);				\
+			}								\
+		}									\
+		debug_table_grow_##name(t);						\
+		debug_table_step_##name(t, HMEMORY_TABLE_STEP);				\
+		k = kh_put(name, t->table, key, ret);					\
+		if (*ret == -1) {							\
+			return NULL;							\
+		}									\
+		return &kh_value(t->table, k);						\
+	}										\
+											\
+	static inline void debug_table_del_##name (hmemory_table_t(name) *t, khkey_t key)	\
+	{										\
+		khiter_t k;								\
+		k = kh_get(name, t->table, key);					\
+		if (k != kh_end(t->table)) {						\
+			kh_del(name, t->table, k);					\
+		} else if (t->old != NULL) {						\
+			k = kh_get(name, t->old, key);					\
+			if (k != kh_end(t->old)) {					\
+				kh_del(name, t->old, k);				\
+			}								\
+		}									\
+		debug_table_step_##name(t, HMEMORY_TABLE_STEP);				\
+	}
+
+#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+KHASH_INIT(memory, void *, struct hmemory_memory *, 1, hmemory_int64_hash_func, kh_int64_hash_equal);
+HMEMORY_TABLE_INIT(memory, void *, struct hmemory_memory *);
+#endif
+
+/*
+ * fields used by lookups, free and the checks come first, so that with
+ * records aligned to a cache line they are read with a single line. the
+ * allocation site and the name are only read for reports.
+ */
 struct hmemory_memory {
 	void *address;
+	size_t size;
+	void *base;
+	struct hmemory_memory *span;
+	struct hmemory_memory *span_prev;
+	unsigned char kind;
+	unsigned char large;
+	int line;
+	unsigned int slot;
+	const char *func;
+	const char *file;
+	struct hmemory_site *site;
+	unsigned long long time;
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+	UT_hash_handle hh;
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+#endif
+	char name[0];
+};
+
+static pthread_t hmemory_thread;
+static int hmemory_worker_started		= 0;
+static int hmemory_worker_running		= 0;
+static int hmemory_finished			= 0;
+static pthread_once_t hmemory_once		= PTHREAD_ONCE_INIT;
+
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+static struct hmemory_memory *debug_memory	= NULL;
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+static hmemory_table_t(memory) debug_memory;
+#endif
+
+/*
+ * metadata region. records and table arrays of the tracker are kept apart
+ * from the blocks of the program, so that they neither share cache lines
+ * with program data nor spread over the pages of its heap. records are cut
+ * from chunks of HMEMORY_METADATA_CHUNK bytes, mapped with MAP_HUGETLB when
+ * huge pages are reserved and advised with MADV_HUGEPAGE otherwise. every
+ * record starts on a cache line and takes as many lines as its name needs,
+ * freed records are kept on a list per line count, records longer than
+ * HMEMORY_METADATA_LINES lines are allocated like table arrays. those of at
+ * least HMEMORY_METADATA_MAP bytes are mapped on their own, smaller ones come
+ * from malloc, both behind a cache line sized head holding their size. with
+ * hmemory_metadata_region set to 0 records and tables come from malloc.
+ */
+#define HMEMORY_METADATA_CHUNK			(2UL * 1024 * 1024)
+#define HMEMORY_METADATA_MAP			(64UL * 1024)
+#define HMEMORY_METADATA_LINES			16
+
+struct hmemory_metadata_head {
+	size_t size;
+	size_t mapped;
+	int hugetlb;
+} __attribute__ ((aligned(HMEMORY_CACHELINE_SIZE)));
+
+static int debug_metadata_region		= 0;
+static int debug_metadata_hugetlb		= 0;
+static size_t debug_metadata_records		= 0;
+static size_t debug_metadata_tables		= 0;
+
+/*
+ * maps size bytes, on huge pages when possible.
+ */
+static void * debug_metadata_map (size_t size, int *hugetlb)
+{
+	void *address;
+	*hugetlb = 0;
+#if defined(MAP_HUGETLB)
+	if ((size & (HMEMORY_METADATA_CHUNK - 1)) == 0) {
+		address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (address != MAP_FAILED) {
+			*hugetlb = 1;
+			return address;
+		}
+	}
+#endif
+	address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (address == MAP_FAILED) {
+		return NULL;
+	}
+#if defined(MADV_HUGEPAGE)
+	if (size >= HMEMORY_METADATA_CHUNK) {
+		madvise(address, size, MADV_HUGEPAGE);
+	}
+#endif
+	return address;
+}
+
+static void debug_metadata_init (void)
+{
+	debug_metadata_region = (hconfig(metadata_region) != 0);
+}
+
+#if (HMEMORY_ARENA_RECORDS == 0)
+
+static char *debug_metadata_chunk		= NULL;
+static size_t debug_metadata_offset		= 0;
+static void *debug_metadata_lines[HMEMORY_METADATA_LINES + 1];
+
+/*
+ * returns a record of size bytes on a cache line, with the lock held.
+ */
+static void * debug_metadata_record (size_t size)
+{
+	int hugetlb;
+	size_t lines;
+	void *record;
+	lines = (size + HMEMORY_CACHELINE_SIZE - 1) / HMEMORY_CACHELINE_SIZE;
+	if (lines > HMEMORY_METADATA_LINES) {
+		return debug_metadata_malloc(size);
+	}
+	if (debug_metadata_lines[lines] != NULL) {
+		record = debug_metadata_lines[lines];
+		debug_metadata_lines[lines] = *(void **) record;
+		return record;
+	}
+	if (debug_metadata_chunk == NULL || debug_metadata_offset + lines * HMEMORY_CACHELINE_SIZE > HMEMORY_METADATA_CHUNK) {
+		debug_metadata_chunk = debug_metadata_map(HMEMORY_METADATA_CHUNK, &hugetlb);
+		if (debug_metadata_chunk == NULL) {
+			return NULL;
+		}
+		debug_metadata_offset = 0;
+		debug_metadata_hugetlb |= hugetlb;
+		__atomic_add_fetch(&debug_metadata_records, HMEMORY_METADATA_CHUNK, __ATOMIC_RELAXED);
+	}
+	record = debug_metadata_chunk + debug_metadata_offset;
+	debug_metadata_offset += lines * HMEMORY_CACHELINE_SIZE;
+	return record;
+}
+
+/*
+ * gives a record of size bytes back, with the lock held.
+ */
+static void debug_metadata_record_free (void *record, size_t size)
+{
+	size_t lines;
+	lines = (size + HMEMORY_CACHELINE_SIZE - 1) / HMEMORY_CACHELINE_SIZE;
+	if (lines > HMEMORY_METADATA_LINES) {
+		debug_metadata_free(record);
+		return;
+	}
+	*(void **) record = debug_metadata_lines[lines];
+	debug_metadata_lines[lines] = record;
+}
+
+#endif
+
+/*
+ * returns the length of the mapping for size bytes and the head, 0 if they
+ * are to come from malloc.
+ */
+static inline size_t debug_metadata_length (size_t size)
+{
+	size_t length;
+	length = sizeof(struct hmemory_metadata_head) + size;
+	if (debug_metadata_region == 0 || length < HMEMORY_METADATA_MAP) {
+		return 0;
+	}
+	if (length >= HMEMORY_METADATA_CHUNK) {
+		return (length + HMEMORY_METADATA_CHUNK - 1) & ~(HMEMORY_METADATA_CHUNK - 1);
+	}
+	return (length + HMEMORY_METADATA_MAP - 1) & ~(HMEMORY_METADATA_MAP - 1);
+}
+
+static void * debug_metadata_malloc (size_t size)
+{
+	int hugetlb;
+	size_t length;
+	struct hmemory_metadata_head *head;
+	length = debug_metadata_length(size);
+	if (length == 0) {
+		head = malloc(sizeof(struct hmemory_metadata_head) + size);
+		if (head == NULL) {
+			return NULL;
+		}
+		head->mapped = 0;
+		head->hugetlb = 0;
+	} else {
+		head = debug_metadata_map(length, &hugetlb);
+		if (head == NULL) {
+			return NULL;
+		}
+		head->mapped = length;
+		head->hugetlb = hugetlb;
+		debug_metadata_hugetlb |= hugetlb;
+		__atomic_add_fetch(&debug_metadata_tables, length, __ATOMIC_RELAXED);
+	}
+	head->size = size;
+	return head + 1;
+}
+
+static void * debug_metadata_calloc (size_t nmemb, size_t size)
+{
+	void *address;
+	struct hmemory_metadata_head *head;
+	address = debug_metadata_malloc(nmemb * size);
+	if (address == NULL) {
+		return NULL;
+	}
+	head = (struct hmemory_metadata_head *) address - 1;
+	if (head->mapped == 0) {
+		memset(address, 0, nmemb * size);
+	}
+	return address;
+}
+
+static void debug_metadata_free (void *address)
+{
+	struct hmemory_metadata_head *head;
+	if (address == NULL) {
+		return;
+	}
+	head = (struct hmemory_metadata_head *) address - 1;
+	if (head->mapped == 0) {
+		free(head);
+	} else {
+		__atomic_sub_fetch(&debug_metadata_tables, head->mapped, __ATOMIC_RELAXED);
+		munmap(head, head->mapped);
+	}
+}
+
+/*
+ * mappings not on hugetlb pages grow with mremap, so growing arrays are not
+ * copied.
+ */
+static void * debug_metadata_realloc (void *address, size_t size)
+{
+	void *rc;
+	size_t length;
+	size_t mapped;
+	struct hmemory_metadata_head *head;
+	if (address == NULL) {
+		return debug_metadata_malloc(size);
+	}
+	head = (struct hmemory_metadata_head *) address - 1;
+	if (head->mapped != 0 && sizeof(struct hmemory_metadata_head) + size <= head->mapped) {
+		head->size = size;
+		return address;
+	}
+	length = debug_metadata_length(size);
+	if (head->mapped != 0 && head->hugetlb == 0 && length != 0) {
+		mapped = head->mapped;
+		rc = mremap(head, mapped, length, MREMAP_MAYMOVE);
+		if (rc == MAP_FAILED) {
+			return NULL;
+		}
+#if defined(MADV_HUGEPAGE)
+		if (length >= HMEMORY_METADATA_CHUNK) {
+			madvise(rc, length, MADV_HUGEPAGE);
+		}
+#endif
+		__atomic_add_fetch(&debug_metadata_tables, length - mapped, __ATOMIC_RELAXED);
+		head = rc;
+		head->mapped = length;
+		head->size = size;
+		return head + 1;
+	}
+	rc = debug_metadata_malloc(size);
+	if (rc == NULL) {
+		return NULL;
+	}
+	memcpy(rc, address, (head->size < size) ? head->size : size);
+	debug_metadata_free(address);
+	return rc;
+}
+
+static void debug_metadata_report (void)
+{
+	if (debug_metadata_region == 0) {
+		return;
+	}
+	hinfof("    tracker: %zu kb records, %zu kb tables, %s pages",
+		__atomic_load_n(&debug_metadata_records, __ATOMIC_RELAXED) / 1024,
+		__atomic_load_n(&debug_metadata_tables, __ATOMIC_RELAXED) / 1024,
+		(debug_metadata_hugetlb) ? "hugetlb" : "transparent huge");
+}
+
+/*
+ * record arena. with HMEMORY_ARENA_RECORDS set, records are handed out from
+ * a static array, first from its untouched tail and then from a free list,
+ * both in constant time under the hmemory lock, and names are cut to
+ * HMEMORY_ARENA_NAME_MAX bytes. a block allocated while the arena is empty
+ * is not tracked: its base, size and large mapping are stored in the head,
+ * and a check word computed from them, the address and a per process secret
+ * takes the place of its leading signature, so that free and realloc still
+ * find it and a payload can not pass for such a head. the word is cleared
+ * on release. such blocks are not checked, they are counted, and the ones
+ * still allocated at exit are reported as leaks.
+ */
+#if (HMEMORY_ARENA_RECORDS > 0)
+
+union hmemory_arena_record {
+	union hmemory_arena_record *next;
+	struct hmemory_memory memory;
+	char bytes[sizeof(struct hmemory_memory) + HMEMORY_ARENA_NAME_MAX];
+};
+
+static union hmemory_arena_record hmemory_arena_records[HMEMORY_ARENA_RECORDS];
+static union hmemory_arena_record *hmemory_arena_free	= NULL;
+static size_t hmemory_arena_tail			= 0;
+static size_t hmemory_arena_used			= 0;
+static size_t hmemory_arena_peak			= 0;
+static unsigned long long hmemory_arena_untracked	= 0;
+static unsigned long long hmemory_arena_live		= 0;
+static unsigned long long hmemory_arena_live_bytes	= 0;
+static uintptr_t hmemory_arena_secret			= 0;
+
+static UT_hash_table hmemory_arena_table;
+static UT_hash_bucket hmemory_arena_buckets[HMEMORY_ARENA_BUCKETS];
+
+static void * debug_arena_table (size_t size)
+{
+	return (size == sizeof(UT_hash_table)) ? (void *) &hmemory_arena_table : (void *) hmemory_arena_buckets;
+}
+
+#endif
+
+/*
+ * returns a zeroed record named name, with the lock held.
+ */
+static inline struct hmemory_memory * debug_memory_alloc (const char *name)
+{
+	struct hmemory_memory *m;
+#if (HMEMORY_ARENA_RECORDS > 0)
+	size_t length;
+	union hmemory_arena_record *r;
+	if (hmemory_arena_free != NULL) {
+		r = hmemory_arena_free;
+		hmemory_arena_free = r->next;
+	} else if (hmemory_arena_tail < HMEMORY_ARENA_RECORDS) {
+		r = &hmemory_arena_records[hmemory_arena_tail++];
+	} else {
+		return NULL;
+	}
+	if (++hmemory_arena_used > hmemory_arena_peak) {
+		hmemory_arena_peak = hmemory_arena_used;
+	}
+	length = strnlen(name, HMEMORY_ARENA_NAME_MAX - 1);
+	m = &r->memory;
+	memset(m, 0, sizeof(struct hmemory_memory));
+	memcpy(m->name, name, length);
+	m->name[length] = '\0';
+	m->slot = HMEMORY_SCAN_NONE;
+#else
+	size_t s;
+	s = sizeof(struct hmemory_memory) + strlen(name) + 1;
+	m = (debug_metadata_region) ? debug_metadata_record(s) : malloc(s);
+	if (m == NULL) {
+		return NULL;
+	}
+	memset(m, 0, s);
+	memcpy(m->name, name, strlen(name) + 1);
+	m->slot = HMEMORY_SCAN_NONE;
+#endif
+	return m;
+}
+
+/*
+ * gives a record back, with the lock held.
+ */
+static inline void debug_memory_free (struct hmemory_memory *m)
+{
+#if (HMEMORY_ARENA_RECORDS > 0)
+	union hmemory_arena_record *r;
+	r = (union hmemory_arena_record *) m;
+	r->next = hmemory_arena_free;
+	hmemory_arena_free = r;
+	hmemory_arena_used--;
+#else
+	if (debug_metadata_region) {
+		debug_metadata_record_free(m, sizeof(struct hmemory_memory) + strlen(m->name) + 1);
+	} else {
+		free(m);
+	}
+#endif
+}
+
+/*
+ * check word of a block that is not tracked.
+ */
+static inline uintptr_t debug_arena_check (void *address, void *base, size_t size, size_t large)
+{
+#if (HMEMORY_ARENA_RECORDS > 0)
+	uint64_t h;
+	h = hmemory_arena_secret;
+	h = (h ^ (uintptr_t) address) * 0x9e3779b97f4a7c15ULL;
+	h = (h ^ (uintptr_t) base) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ size) * 0x94d049bb133111ebULL;
+	h = (h ^ large) * 0x9e3779b97f4a7c15ULL;
+	return (uintptr_t) (h ^ (h >> 31));
+#else
+	(void) address;
+	(void) base;
+	(void) size;
+	(void) large;
+	return 0;
+#endif
+}
+
+/*
+ * marks a block for which there was no record left, with the lock held.
+ */
+static inline void debug_arena_untrack (void *base, void *address, size_t size, int large, const char *command, const char *func, const char *file, const int line)
+{
+#if (HMEMORY_ARENA_RECORDS > 0)
+	size_t l;
+	uintptr_t check;
+	l = large;
+	check = debug_arena_check(address, base, size, l);
+	memcpy(address, &check, sizeof(check));
+	memcpy(address - sizeof(void *), &base, sizeof(void *));
+	memcpy(address - sizeof(void *) - sizeof(size_t), &size, sizeof(size_t));
+	memcpy(address - sizeof(void *) - sizeof(size_t) * 2, &l, sizeof(size_t));
+	hmemory_arena_live += 1;
+	hmemory_arena_live_bytes += size - (hmemory_signature_size * 2);
+	if (__atomic_fetch_add(&hmemory_arena_untracked, 1, __ATOMIC_RELAXED) == 0) {
+		hdebug_lock();
+		hinfof("%s with tracking capacity exhausted, all %d records are in use", command, HMEMORY_ARENA_RECORDS);
+		hinfof("    at: %s (%s:%d)", func, file, line);
+		debug_dump_callstack("       ");
+		hinfof("  blocks are not tracked until records are released, they are not checked,");
+		hinfof("  counted in the memory information and reported as leaks at exit when still");
+		hinfof("  allocated. rebuild with a larger HMEMORY_ARENA_RECORDS to track them all");
+		hdebug_unlock();
+	}
+#else
+	(void) base;
+	(void) address;
+	(void) size;
+	(void) large;
+	(void) command;
+	(void) func;
+	(void) file;
+	(void) line;
+#endif
+}
+
+/*
+ * returns 1 if address, not found in the tables, is a block that is not
+ * tracked, along with its base, size and large mapping, with the lock held.
+ */
+static inline int debug_arena_untracked (void *address, void **base, size_t *size, int *large)
+{
+#if (HMEMORY_ARENA_RECORDS > 0)
+	void *b;
+	size_t s;
+	size_t l;
+	uintptr_t check;
+	if (__atomic_load_n(&hmemory_arena_live, __ATOMIC_RELAXED) == 0) {
+		return 0;
+	}
+	memcpy(&check, address, sizeof(check));
+	memcpy(&b, address - sizeof(void *), sizeof(void *));
+	memcpy(&s, address - sizeof(void *) - sizeof(size_t), sizeof(size_t));
+	memcpy(&l, address - sizeof(void *) - sizeof(size_t) * 2, sizeof(size_t));
+	if (b >= address || s < (size_t) hmemory_signature_size * 2 || (l & ~(size_t) 0xff) != 0 ||
+	    check != debug_arena_check(address, b, s, l)) {
+		return 0;
+	}
+	if (base != NULL) {
+		*base = b;
+	}
+	if (size != NULL) {
+		*size = s;
+	}
+	if (large != NULL) {
+		*large = (int) l;
+	}
+	return 1;
+#else
+	(void) address;
+	(void) base;
+	(void) size;
+	(void) large;
+	return 0;
+#endif
+}
+
+/*
+ * forgets a block that is not tracked on release, with the lock held.
+ */
+static inline void debug_arena_release (void *address, size_t size)
+{
+#if (HMEMORY_ARENA_RECORDS > 0)
+	memset(address, 0, hmemory_signature_size);
+	hmemory_arena_live -= 1;
+	hmemory_arena_live_bytes -= size - (hmemory_signature_size * 2);
+#else
+	(void) address;
+	(void) size;
+#endif
+}
+
+/*
+ * reports blocks that are not tracked and still allocated at exit, returns
+ * their number.
+ */
+static inline unsigned long long debug_arena_report (void)
+{
+#if (HMEMORY_ARENA_RECORDS > 0)
+	if (hmemory_arena_live == 0) {
+		return 0;
+	}
+	hinfof("    untracked: %llu bytes in %llu blocks still allocated, not tracked for lack of records", hmemory_arena_live_bytes, hmemory_arena_live);
+	return hmemory_arena_live;
+#else
+	return 0;
+#endif
+}
+
+/*
+ * span index, finds the tracked block containing an arbitrary address for
+ * bounds checks. blocks are chained under the page of their address, in
+ * both directions so that a block is unlinked without walking the chain, and
+ * every region a block extends into from an earlier region points to that
+ * block, only one block can cover the start of a region. a lookup scans the
+ * chain of the page, the entry of the region and the chains of the earlier
+ * pages of the region. addresses outside the lowest and highest tracked
+ * block are rejected without taking a lock.
+ *
+ * the index has a reader writer lock of its own. it is written with the
+ * hmemory lock held, and only while blocks are added and removed, bounds
+ * checks read it and the records it points to without the hmemory lock, so
+ * copies do not wait for allocations and do not wait for each other.
+ * writers are preferred, a steady stream of copies does not hold off frees.
+ */
+#define HMEMORY_SPAN_PAGE_SHIFT			12
+#define HMEMORY_SPAN_REGION_SHIFT		16
+
+KHASH_INIT(span, uintptr_t, struct hmemory_memory *, 1, hmemory_int64_hash_func, kh_int64_hash_equal);
+HMEMORY_TABLE_INIT(span, uintptr_t, struct hmemory_memory *);
+
+static hmemory_table_t(span) debug_span_pages;
+static hmemory_table_t(span) debug_span_regions;
+static uintptr_t debug_span_low			= UINTPTR_MAX;
+static uintptr_t debug_span_high		= 0;
+static pthread_rwlock_t debug_span_lock		= PTHREAD_RWLOCK_INITIALIZER;
+
+KHASH_INIT(large, void *, struct hmemory_memory *, 1, hmemory_int64_hash_func, kh_int64_hash_equal);
+HMEMORY_TABLE_INIT(large, void *, struct hmemory_memory *);
+
+static hmemory_table_t(large) debug_large;
+static size_t debug_large_page			= 0;
+
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+
+/*
+ * blocks the interposers hand out untracked while hmemory is not on the
+ * stack, before tracking started or to the dynamic loader, are remembered.
+ * an address hmemory does not know is passed to the next allocator only if
+ * it is one of them, anything else is a double or an invalid release and is
+ * reported. tables are not set up before tracking starts, so early blocks
+ * go to a fixed array. if that fills up or a table insert fails, unknown
+ * addresses can no longer be told apart and are all passed on.
+ */
+#define HMEMORY_PRELOAD_EARLY			1024
+
+KHASH_INIT(passed, uintptr_t, char, 1, hmemory_int64_hash_func, kh_int64_hash_equal);
+HMEMORY_TABLE_INIT(passed, uintptr_t, char);
+
+static hmemory_table_t(passed) debug_passed;
+static uintptr_t hmemory_preload_early[HMEMORY_PRELOAD_EARLY];
+static unsigned int hmemory_preload_nearly;
+static int hmemory_preload_lost;
+
+static void debug_preload_pass (void *address)
+{
+	int rc;
+	unsigned int i;
+	if (address == NULL) {
+		return;
+	}
+	if (__atomic_load_n(&hmemory_preload_active, __ATOMIC_ACQUIRE) == 0) {
+		i = __atomic_load_n(&hmemory_preload_nearly, __ATOMIC_RELAXED);
+		if (i < HMEMORY_PRELOAD_EARLY) {
+			i = __atomic_fetch_add(&hmemory_preload_nearly, 1, __ATOMIC_RELAXED);
+		}
+		if (i < HMEMORY_PRELOAD_EARLY) {
+			__atomic_store_n(&hmemory_preload_early[i], (uintptr_t) address, __ATOMIC_RELEASE);
+		} else {
+			__atomic_store_n(&hmemory_preload_lost, 1, __ATOMIC_RELEASE);
+		}
+		return;
+	}
+	hmemory_lock();
+	if (debug_table_put_passed(&debug_passed, (uintptr_t) address, &rc) == NULL) {
+		__atomic_store_n(&hmemory_preload_lost, 1, __ATOMIC_RELEASE);
+	}
+	hmemory_unlock();
+}
+
+static int debug_preload_early_forget (void *address)
+{
+	unsigned int i;
+	unsigned int n;
+	uintptr_t a;
+	n = __atomic_load_n(&hmemory_preload_nearly, __ATOMIC_ACQUIRE);
+	if (n > HMEMORY_PRELOAD_EARLY) {
+		n = HMEMORY_PRELOAD_EARLY;
+	}
+	for (i = 0; i < n; i++) {
+		a = (uintptr_t) address;
+		if (__atomic_compare_exchange_n(&hmemory_preload_early[i], &a, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * with the lock held, returns 1 and forgets address if it was handed out
+ * untracked, or if that can no longer be told.
+ */
+static int debug_preload_passed (void *address)
+{
+	if (debug_table_get_passed(&debug_passed, (uintptr_t) address) != NULL) {
+		debug_table_del_passed(&debug_passed, (uintptr_t) address);
+		return 1;
+	}
+	if (debug_preload_early_forget(address)) {
+		return 1;
+	}
+	return __atomic_load_n(&hmemory_preload_lost, __ATOMIC_ACQUIRE);
+}
+
+#endif
+/*
+ * statistics are kept per thread, padded to a cache line so that threads do
+ * not share lines, and only ever written by the owning thread. readers sum
+ * all threads. peak is tracked against memory_current, which threads update
+ * in batches of HMEMORY_STATISTICS_BATCH bytes; reported peak may lag the
+ * exact value by at most (threads * HMEMORY_STATISTICS_BATCH) bytes.
+ *
+ * records are never unlinked, readers walk the list without locking. when a
+ * thread exits, the key destructor flushes its batch, folds its counters into
+ * hmemory_statistics_exited and leaves the record for the next thread to
+ * claim, so the list is as long as the most threads alive at once.
+ * hmemory_statistics_mutex keeps readers from seeing counters in both places.
+ */
+struct hmemory_statistics {
+	struct hmemory_statistics *next;
+	pthread_t thread;
+	int owned;
+	unsigned long long allocated;
+	unsigned long long freed;
+	unsigned long long nallocated;
+	unsigned long long nfreed;
+	long long batch;
+} __attribute__ ((aligned(HMEMORY_CACHELINE_SIZE)));
+
+static struct hmemory_statistics *hmemory_statistics		= NULL;
+static __thread struct hmemory_statistics *hmemory_statistics_self	= NULL;
+static struct hmemory_statistics hmemory_statistics_exited;
+static pthread_mutex_t hmemory_statistics_mutex			= PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t hmemory_statistics_once			= PTHREAD_ONCE_INIT;
+static pthread_key_t hmemory_statistics_key;
+
+static long long memory_current		__attribute__ ((aligned(HMEMORY_CACHELINE_SIZE))) = 0;
+static long long memory_peak		__attribute__ ((aligned(HMEMORY_CACHELINE_SIZE))) = 0;
+
+static void debug_statistics_flush (struct hmemory_statistics *s)
+{
+	long long c;
+	long long p;
+	c = __atomic_add_fetch(&memory_current, s->batch, __ATOMIC_RELAXED);
+	s->batch = 0;
+	p = __atomic_load_n(&memory_peak, __ATOMIC_RELAXED);
+	while (c > p) {
+		if (__atomic_compare_exchange_n(&memory_peak, &p, c, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+}
+
+/*
+ * key destructor, runs when a thread that updated statistics exits.
+ */
+static void debug_statistics_retire (void *arg)
+{
+	struct hmemory_statistics *s;
+	s = arg;
+	debug_statistics_flush(s);
+	pthread_mutex_lock(&hmemory_statistics_mutex);
+	hmemory_statistics_exited.allocated += s->allocated;
+	hmemory_statistics_exited.freed += s->freed;
+	hmemory_statistics_exited.nallocated += s->nallocated;
+	hmemory_statistics_exited.nfreed += s->nfreed;
+	__atomic_store_n(&s->allocated, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&s->freed, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&s->nallocated, 0, __ATOMIC_RELAXED);
+	__atomic_store_n(&s->nfreed, 0, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&hmemory_statistics_mutex);
+	if (hmemory_statistics_self == s) {
+		hmemory_statistics_self = NULL;
+	}
+	__atomic_store_n(&s->owned, 0, __ATOMIC_RELEASE);
+}
+
+static void debug_statistics_key (void)
+{
+	if (pthread_key_create(&hmemory_statistics_key, debug_statistics_retire) != 0) {
+		herrorf("can not create statistics key");
+	}
+}
+
+static struct hmemory_statistics * debug_statistics_self (void)
+{
+	int owned;
+	struct hmemory_statistics *s;
+	if (hmemory_statistics_self != NULL) {
+		return hmemory_statistics_self;
+	}
+	pthread_once(&hmemory_statistics_once, debug_statistics_key);
+	for (s = __atomic_load_n(&hmemory_statistics, __ATOMIC_ACQUIRE); s != NULL; s = s->next) {
+		owned = 0;
+		if (__atomic_load_n(&s->owned, __ATOMIC_RELAXED) == 0 &&
+		    __atomic_compare_exchange_n(&s->owned, &owned, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+	if (s == NULL) {
+		if (posix_memalign((void **) &s, HMEMORY_CACHELINE_SIZE, sizeof(struct hmemory_statistics)) != 0) {
+			return NULL;
+		}
+		memset(s, 0, sizeof(struct hmemory_statistics));
+		s->owned = 1;
+		s->next = __atomic_load_n(&hmemory_statistics, __ATOMIC_ACQUIRE);
+		while (!__atomic_compare_exchange_n(&hmemory_statistics, &s->next, s, 1, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+		}
+	}
+	s->thread = pthread_self();
+	hmemory_statistics_self = s;
+	pthread_setspecific(hmemory_statistics_key, s);
+	return s;
+}
+
+static void debug_statistics_add (size_t size)
+{
+	struct hmemory_statistics *s;
+	s = debug_statistics_self();
+	if (s == NULL) {
+		return;
+	}
+	__atomic_store_n(&s->allocated, s->allocated + size, __ATOMIC_RELAXED);
+	__atomic_store_n(&s->nallocated, s->nallocated + 1, __ATOMIC_RELAXED);
+	s->batch += size;
+	if (s->batch >= HMEMORY_STATISTICS_BATCH) {
+		debug_statistics_flush(s);
+	}
+}
+
+static void debug_statistics_del (size_t size)
+{
+	struct hmemory_statistics *s;
+	s = debug_statistics_self();
+	if (s == NULL) {
+		return;
+	}
+	__atomic_store_n(&s->freed, s->freed + size, __ATOMIC_RELAXED);
+	__atomic_store_n(&s->nfreed, s->nfreed + 1, __ATOMIC_RELAXED);
+	s->batch -= size;
+	if (s->batch <= -HMEMORY_STATISTICS_BATCH) {
+		debug_statistics_flush(s);
+	}
+}
+
+static void debug_statistics_get (unsigned long long *current, unsigned long long *peak, unsigned long long *total)
+{
+	long long p;
+	unsigned long long t;
+	unsigned long long f;
+	struct hmemory_statistics *s;
+	pthread_mutex_lock(&hmemory_statistics_mutex);
+	t = hmemory_statistics_exited.allocated;
+	f = hmemory_statistics_exited.freed;
+	for (s = __atomic_load_n(&hmemory_statistics, __ATOMIC_ACQUIRE); s != NULL; s = s->next) {
+		t += __atomic_load_n(&s->allocated, __ATOMIC_RELAXED);
+		f += __atomic_load_n(&s->freed, __ATOMIC_RELAXED);
+	}
+	pthread_mutex_unlock(&hmemory_statistics_mutex);
+	p = __atomic_load_n(&memory_peak, __ATOMIC_RELAXED);
+	*current = t - f;
+	*peak = MAX(p, (long long) (t - f));
+	*total = t;
+}
+
+/*
+ * runs in the child of a fork, the only thread left. parent counters are
+ * folded into the record of the forking thread as its current usage, and
+ * records of threads that did not survive the fork are dropped.
+ */
+static void debug_statistics_fork (void)
+{
+	unsigned long long peak;
+	unsigned long long total;
+	unsigned long long current;
+	struct hmemory_statistics *s;
+	struct hmemory_statistics *n;
+	struct hmemory_statistics *self;
+	debug_statistics_get(&current, &peak, &total);
+	self = debug_statistics_self();
+	if (self == NULL) {
+		return;
+	}
+	for (s = hmemory_statistics; s != NULL; s = n) {
+		n = s->next;
+		if (s != self) {
+			free(s);
+		}
+	}
+	memset(self, 0, sizeof(struct hmemory_statistics));
+	memset(&hmemory_statistics_exited, 0, sizeof(struct hmemory_statistics));
+	self->thread = pthread_self();
+	self->owned = 1;
+	self->allocated = current;
+	hmemory_statistics = self;
+	memory_current = current;
+	memory_peak = current;
+}
+
+static void debug_statistics_report (void)
+{
+	unsigned long long peak;
+	unsigned long long total;
+	unsigned long long current;
+	struct hmemory_statistics *s;
+	debug_statistics_get(&current, &peak, &total);
+	hinfof("memory information:")
+	hinfof("    current: %llu bytes (%.02f mb)", current, ((double) current) / (1024.00 * 1024.00));
+	hinfof("    peak   : %llu bytes (%.02f mb)", peak, ((double) peak) / (1024.00 * 1024.00));
+	hinfof("    total  : %llu bytes (%.02f mb)", total, ((double) total) / (1024.00 * 1024.00));
+#if (HMEMORY_ARENA_RECORDS > 0)
+	hinfof("    arena  : %zu of %d records, peak %zu, %llu blocks not tracked, %llu bytes in %llu of them live", hmemory_arena_used, HMEMORY_ARENA_RECORDS, hmemory_arena_peak, __atomic_load_n(&hmemory_arena_untracked, __ATOMIC_RELAXED), __atomic_load_n(&hmemory_arena_live_bytes, __ATOMIC_RELAXED), __atomic_load_n(&hmemory_arena_live, __ATOMIC_RELAXED));
+#endif
+	debug_metadata_report();
+	hinfof("    threads:");
+	pthread_mutex_lock(&hmemory_statistics_mutex);
+	if (hmemory_statistics_exited.nallocated + hmemory_statistics_exited.nfreed > 0) {
+		hinfof("      - exited   : allocated: %llu bytes (%llu), freed: %llu bytes (%llu), live: %lld bytes",
+			hmemory_statistics_exited.allocated, hmemory_statistics_exited.nallocated,
+			hmemory_statistics_exited.freed, hmemory_statistics_exited.nfreed,
+			(long long) (hmemory_statistics_exited.allocated - hmemory_statistics_exited.freed));
+	}
+	for (s = __atomic_load_n(&hmemory_statistics, __ATOMIC_ACQUIRE); s != NULL; s = s->next) {
+		unsigned long long a;
+		unsigned long long f;
+		if (__atomic_load_n(&s->owned, __ATOMIC_ACQUIRE) == 0) {
+			continue;
+		}
+		a = __atomic_load_n(&s->allocated, __ATOMIC_RELAXED);
+		f = __atomic_load_n(&s->freed, __ATOMIC_RELAXED);
+		hinfof("      - %#lx: allocated: %llu bytes (%llu), freed: %llu bytes (%llu), live: %lld bytes",
+			(unsigned long) s->thread,
+			a, __atomic_load_n(&s->nallocated, __ATOMIC_RELAXED),
+			f, __atomic_load_n(&s->nfreed, __ATOMIC_RELAXED),
+			(long long) (a - f));
+	}
+	pthread_mutex_unlock(&hmemory_statistics_mutex);
+}
+
+/*
+ * sites are kept in open addressing tables of HMEMORY_SITE_MAX slots, keyed
+ * by the func, file and line of the call and filled lock-free. a site starts
+ * with its key, the rest is zeroed and updated by the owner of the table.
+ * with the arena, sites come from a static array of HMEMORY_ARENA_SITES and
+ * one that loses the race for its slot is not reused. once a table or its
+ * arena is full, new sites are accounted to the fallback site of the table.
+ */
+struct hmemory_site_key {
+	const char *func;
+	const char *file;
+	int line;
+};
+
+struct hmemory_site_table {
+	struct hmemory_site_key *slots[HMEMORY_SITE_MAX];
+	struct hmemory_site_key *other;
+	size_t size;
+	unsigned char *arena;
+	unsigned int narena;
+};
+
+#if (HMEMORY_ARENA_RECORDS > 0)
+#define HMEMORY_SITE_TABLE(other, arena)	{ { NULL }, &(other).key, sizeof(other), (unsigned char *) (arena), 0 }
+#else
+#define HMEMORY_SITE_TABLE(other, arena)	{ { NULL }, &(other).key, sizeof(other), NULL, 0 }
+#endif
+
+static inline struct hmemory_site_key * debug_site_table_alloc (struct hmemory_site_table *table)
+{
+#if (HMEMORY_ARENA_RECORDS > 0)
+	unsigned int i;
+	if (__atomic_load_n(&table->narena, __ATOMIC_RELAXED) >= HMEMORY_ARENA_SITES) {
+		return NULL;
+	}
+	i = __atomic_fetch_add(&table->narena, 1, __ATOMIC_RELAXED);
+	return (i < HMEMORY_ARENA_SITES) ? (struct hmemory_site_key *) (table->arena + table->size * i) : NULL;
+#else
+	return calloc(1, table->size);
+#endif
+}
+
+static inline void debug_site_table_put (struct hmemory_site_key *key)
+{
+#if (HMEMORY_ARENA_RECORDS > 0)
+	(void) key;
+#else
+	free(key);
+#endif
+}
+
+static struct hmemory_site_key * debug_site_table_get (struct hmemory_site_table *table, const char *func, const char *file, const int line)
+{
+	unsigned int i;
+	unsigned int h;
+	struct hmemory_site_key *s;
+	struct hmemory_site_key *n;
+	h = (unsigned int) ((((uintptr_t) func) >> 3) ^ (((uintptr_t) file) >> 3) * 31 ^ ((unsigned int) line) * 2654435761U);
+	n = NULL;
+	for (i = 0; i < HMEMORY_SITE_MAX; i++) {
+		struct hmemory_site_key **slot;
+		slot = &table->slots[(h + i) & (HMEMORY_SITE_MAX - 1)];
+		s = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+		if (s == NULL) {
+			if (n == NULL) {
+				n = debug_site_table_alloc(table);
+				if (n == NULL) {
+					return table->other;
+				}
+				n->func = func;
+				n->file = file;
+				n->line = line;
+			}
+			if (__atomic_compare_exchange_n(slot, &s, n, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+				return n;
+			}
+		}
+		if (s->line == line && s->func == func && s->file == file) {
+			debug_site_table_put(n);
+			return s;
+		}
+	}
+	debug_site_table_put(n);
+	return table->other;
+}
+
+/*
+ * site in slot i of the table, the fallback site at HMEMORY_SITE_MAX.
+ */
+static inline struct hmemory_site_key * debug_site_table_at (struct hmemory_site_table *table, unsigned int i)
+{
+	return (i == HMEMORY_SITE_MAX) ? table->other : __atomic_load_n(&table->slots[i], __ATOMIC_ACQUIRE);
+}
+
+/*
+ * histograms are updated with relaxed atomic increments, both globally and per
+ * allocation site.
+ *
+ *   size    : log2 of requested size, bucket i holds [2^(i-1), 2^i)
+ *   class   : glibc malloc bin index of the chunk serving the request
+ *   lifetime: log2 of nanoseconds between allocation and free
+ */
+struct hmemory_histogram {
+	unsigned long long size[HMEMORY_HISTOGRAM_BUCKETS];
+	unsigned long long class[HMEMORY_HISTOGRAM_CLASSES];
+	unsigned long long lifetime[HMEMORY_HISTOGRAM_BUCKETS];
+};
+
+struct hmemory_site {
+	struct hmemory_site_key key;
+	struct hmemory_histogram histogram;
+};
+
+static struct hmemory_histogram hmemory_histogram;
+static struct hmemory_site hmemory_site_other = { { "(other)", "(other)", 0 }, { { 0 }, { 0 }, { 0 } } };
+
+#if (HMEMORY_ARENA_RECORDS > 0)
+static struct hmemory_site hmemory_arena_sites[HMEMORY_ARENA_SITES];
+#endif
+
+static struct hmemory_site_table hmemory_sites = HMEMORY_SITE_TABLE(hmemory_site_other, hmemory_arena_sites);
+
+static inline unsigned int debug_histogram_log2 (unsigned long long value)
+{
+	if (value == 0) {
+		return 0;
+	}
+	return 64 - __builtin_clzll(value);
+}
+
+static inline unsigned int debug_histogram_class (size_t size)
+{
+	unsigned long chunk;
+	chunk = (size + sizeof(size_t) + 15) & ~15UL;
+	if (chunk < 32) {
+		chunk = 32;
+	}
+	if (chunk < 1024) {
+		return chunk >> 4;
+	}
+	if ((chunk >> 6) <= 48) {
+		return 48 + (chunk >> 6);
+	}
+	if ((chunk >> 9) <= 20) {
+		return 91 + (chunk >> 9);
+	}
+	if ((chunk >> 12) <= 10) {
+		return 110 + (chunk >> 12);
+	}
+	if ((chunk >> 15) <= 4) {
+		return 119 + (chunk >> 15);
+	}
+	if ((chunk >> 18) <= 2) {
+		return 124 + (chunk >> 18);
+	}
+	return 126;
+}
+
+/*
+ * smallest chunk of a class, the inverse of debug_histogram_class. the first
+ * class of a range starts where the previous range ends, not on its own
+ * spacing. class 127 is never used.
+ */
+static unsigned long debug_histogram_class_size (unsigned int class)
+{
+	if (class <= 2) {
+		return 32;
+	}
+	if (class <= 63) {
+		return (unsigned long) class << 4;
+	}
+	if (class <= 96) {
+		return (unsigned long) (class - 48) << 6;
+	}
+	if (class == 97) {
+		return 49UL << 6;
+	}
+	if (class <= 111) {
+		return (unsigned long) (class - 91) << 9;
+	}
+	if (class == 112) {
+		return 21UL << 9;
+	}
+	if (class <= 120) {
+		return (unsigned long) (class - 110) << 12;
+	}
+	if (class <= 123) {
+		return (unsigned long) (class - 119) << 15;
+	}
+	if (class == 124) {
+		return 5UL << 15;
+	}
+	if (class <= 126) {
+		return (unsigned long) (class - 124) << 18;
+	}
+	return 1UL << 24;
+}
+
+static int debug_histogram_empty (const struct hmemory_histogram *histogram)
+{
+	unsigned int i;
+	for (i = 0; i < HMEMORY_HISTOGRAM_BUCKETS; i++) {
+		if (__atomic_load_n(&histogram->size[i], __ATOMIC_RELAXED) != 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static inline void debug_histogram_inc (unsigned long long *bucket)
+{
+	__atomic_fetch_add(bucket, 1, __ATOMIC_RELAXED);
+}
+
+static struct hmemory_site * debug_site_get (const char *func, const char *file, const int line)
+{
+	return (struct hmemory_site *) debug_site_table_get(&hmemory_sites, func, file, line);
+}
+
+static void debug_histogram_add (struct hmemory_site *site, size_t size)
+{
+	unsigned int b;
+	unsigned int c;
+	b = debug_histogram_log2(size);
+	c = debug_histogram_class(size);
+	debug_histogram_inc(&hmemory_histogram.size[b]);
+	debug_histogram_inc(&hmemory_histogram.class[c]);
+	debug_histogram_inc(&site->histogram.size[b]);
+	debug_histogram_inc(&site->histogram.class[c]);
+}
+
+static void debug_histogram_del (struct hmemory_site *site, unsigned long long time)
+{
+	unsigned long long now;
+	unsigned int b;
+	now = debug_getclock_ns();
+	b = debug_histogram_log2((now > time) ? (now - time) : 0);
+	debug_histogram_inc(&hmemory_histogram.lifetime[b]);
+	debug_histogram_inc(&site->histogram.lifetime[b]);
+}
+
+static void debug_histogram_print (const char *prefix, const struct hmemory_histogram *histogram)
+{
+	unsigned int i;
+	unsigned long long v;
+	hinfof("%ssize:", prefix);
+	for (i = 0; i < HMEMORY_HISTOGRAM_BUCKETS; i++) {
+		v = __atomic_load_n(&histogram->size[i], __ATOMIC_RELAXED);
+		if (v != 0) {
+			hinfof("%s  < %-12llu: %llu", prefix, (i == 0) ? 1ULL : (i >= 64) ? ~0ULL : (1ULL << i), v);
+		}
+	}
+	hinfof("%sclass:", prefix);
+	for (i = 0; i < HMEMORY_HISTOGRAM_CLASSES; i++) {
+		v = __atomic_load_n(&histogram->class[i], __ATOMIC_RELAXED);
+		if (v != 0) {
+			hinfof("%s  bin %3u (chunk >= %lu): %llu", prefix, i, debug_histogram_class_size(i), v);
+		}
+	}
+	hinfof("%slifetime:", prefix);
+	for (i = 0; i < HMEMORY_HISTOGRAM_BUCKETS; i++) {
+		v = __atomic_load_n(&histogram->lifetime[i], __ATOMIC_RELAXED);
+		if (v != 0) {
+			hinfof("%s  < %-12llu ns: %llu", prefix, (i == 0) ? 1ULL : (i >= 64) ? ~0ULL : (1ULL << i), v);
+		}
+	}
+}
+
+static void debug_json_string (FILE *fp, const char *string)
+{
+	fputc('"', fp);
+	for (; string != NULL && *string != '\0'; string++) {
+		if (*string == '"' || *string == '\\') {
+			fputc('\\', fp);
+		}
+		fputc(*string, fp);
+	}
+	fputc('"', fp);
+}
+
+static void debug_histogram_json_array (FILE *fp, const char *name, const unsigned long long *values, unsigned int count)
+{
+	unsigned int i;
+	fprintf(fp, "\"%s\": [", name);
+	for (i = 0; i < count; i++) {
+		fprintf(fp, "%s%llu", (i == 0) ? "" : ", ", values[i]);
+	}
+	fprintf(fp, "]");
+}
+
+static void debug_histogram_json (FILE *fp, const struct hmemory_histogram *histogram)
+{
+	debug_histogram_json_array(fp, "size_log2", histogram->size, HMEMORY_HISTOGRAM_BUCKETS);
+	fprintf(fp, ", ");
+	debug_histogram_json_array(fp, "size_class", histogram->class, HMEMORY_HISTOGRAM_CLASSES);
+	fprintf(fp, ", ");
+	debug_histogram_json_array(fp, "lifetime_log2_ns", histogram->lifetime, HMEMORY_HISTOGRAM_BUCKETS);
+}
+
+/*
+ * the histogram file is written from a snapshot, taken with the lock held
+ * and written after it is released, so that file io does not hold up the
+ * program.
+ */
+struct hmemory_histogram_snapshot {
+	char path[sizeof(((struct hmemory_config *) 0)->histogram_file)];
+	struct hmemory_histogram global;
+	struct hmemory_site *sites;
+	unsigned int nsites;
+};
+
+static void debug_histogram_copy (struct hmemory_histogram *dst, const struct hmemory_histogram *src)
+{
+	unsigned int i;
+	for (i = 0; i < HMEMORY_HISTOGRAM_BUCKETS; i++) {
+		dst->size[i] = __atomic_load_n(&src->size[i], __ATOMIC_RELAXED);
+		dst->lifetime[i] = __atomic_load_n(&src->lifetime[i], __ATOMIC_RELAXED);
+	}
+	for (i = 0; i < HMEMORY_HISTOGRAM_CLASSES; i++) {
+		dst->class[i] = __atomic_load_n(&src->class[i], __ATOMIC_RELAXED);
+	}
+}
+
+/*
+ * returns 1 if a histogram file is configured and snapshot was taken.
+ */
+static int debug_histogram_snapshot (struct hmemory_histogram_snapshot *snapshot)
+{
+	unsigned int i;
+	unsigned int n;
+	const char *e;
+	struct hmemory_site *s;
+	e = hconfig(histogram_file);
+	if (*e == '\0') {
+		return 0;
+	}
+	snprintf(snapshot->path, sizeof(snapshot->path), "%s", e);
+	debug_histogram_copy(&snapshot->global, &hmemory_histogram);
+	for (n = 0, i = 0; i <= HMEMORY_SITE_MAX; i++) {
+		s = (struct hmemory_site *) debug_site_table_at(&hmemory_sites, i);
+		if (s != NULL && !debug_histogram_empty(&s->histogram)) {
+			n++;
+		}
+	}
+	snapshot->nsites = 0;
+	snapshot->sites = (n == 0) ? NULL : malloc(sizeof(struct hmemory_site) * n);
+	for (i = 0; i <= HMEMORY_SITE_MAX && snapshot->sites != NULL && snapshot->nsites < n; i++) {
+		s = (struct hmemory_site *) debug_site_table_at(&hmemory_sites, i);
+		if (s == NULL || debug_histogram_empty(&s->histogram)) {
+			continue;
+		}
+		snapshot->sites[snapshot->nsites].key = s->key;
+		debug_histogram_copy(&snapshot->sites[snapshot->nsites].histogram, &s->histogram);
+		snapshot->nsites++;
+	}
+	return 1;
+}
+
+/*
+ * writes the snapshot to its file and releases it, without the lock.
+ */
+static int debug_histogram_export (struct hmemory_histogram_snapshot *snapshot)
+{
+	FILE *fp;
+	unsigned int i;
+	struct hmemory_site *s;
+	fp = fopen(snapshot->path, "w");
+	if (fp == NULL) {
+		herrorf("can not open histogram file: %s", snapshot->path);
+		free(snapshot->sites);
+		return -1;
+	}
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"pid\": %d,\n", getpid());
+	fprintf(fp, "  \"size_class_min\": [");
+	for (i = 0; i < HMEMORY_HISTOGRAM_CLASSES; i++) {
+		fprintf(fp, "%s%lu", (i == 0) ? "" : ", ", debug_histogram_class_size(i));
+	}
+	fprintf(fp, "],\n");
+	fprintf(fp, "  \"global\": { ");
+	debug_histogram_json(fp, &snapshot->global);
+	fprintf(fp, " },\n");
+	fprintf(fp, "  \"sites\": [");
+	for (i = 0; i < snapshot->nsites; i++) {
+		s = &snapshot->sites[i];
+		fprintf(fp, "%s\n    { \"func\": ", (i == 0) ? "" : ",");
+		debug_json_string(fp, s->key.func);
+		fprintf(fp, ", \"file\": ");
+		debug_json_string(fp, s->key.file);
+		fprintf(fp, ", \"line\": %d, ", s->key.line);
+		debug_histogram_json(fp, &s->histogram);
+		fprintf(fp, " }");
+	}
+	fprintf(fp, "\n  ]\n");
+	fprintf(fp, "}\n");
+	fclose(fp);
+	free(snapshot->sites);
+	return 0;
+}
+
+static void debug_histogram_report (void)
+{
+	int v;
+	unsigned int i;
+	struct hmemory_site *s;
+	v = hconfig(report_histogram);
+	if (v >= 1) {
+		hinfof("  histograms:");
+		debug_histogram_print("    ", &hmemory_histogram);
+	}
+	if (v >= 2) {
+		for (i = 0; i <= HMEMORY_SITE_MAX; i++) {
+			s = (struct hmemory_site *) debug_site_table_at(&hmemory_sites, i);
+			if (s == NULL || debug_histogram_empty(&s->histogram)) {
+				continue;
+			}
+			hinfof("    site: %s (%s:%d)", s->key.func, s->key.file, s->key.line);
+			debug_histogram_print("      ", &s->histogram);
+		}
+	}
+}
+
+/*
+ * copy profile, every mem and str wrapper charges its bytes to the calling
+ * site. copy sites have a site table of their own, with per operation call
+ * and byte counters and a log2 histogram of copy sizes. the report lists
+ * the sites that copied the most bytes.
+ */
+struct hmemory_copy_site {
+	struct hmemory_site_key key;
+	unsigned long long calls[HMEMORY_COPY_OPS];
+	unsigned long long bytes[HMEMORY_COPY_OPS];
+	unsigned long long size[HMEMORY_HISTOGRAM_BUCKETS];
+};
+
+static const char *hmemory_copy_ops[HMEMORY_COPY_OPS] = {
+	"memcpy",
+	"memmove",
+	"memset",
+	"strcpy",
+	"strncpy",
+	"strcat",
+};
+
+static struct hmemory_copy_site hmemory_copy_site_other = { { "(other)", "(other)", 0 }, { 0 }, { 0 }, { 0 } };
+
+#if (HMEMORY_ARENA_RECORDS > 0)
+static struct hmemory_copy_site hmemory_arena_copy_sites[HMEMORY_ARENA_SITES];
+#endif
+
+static struct hmemory_site_table hmemory_copy_sites = HMEMORY_SITE_TABLE(hmemory_copy_site_other, hmemory_arena_copy_sites);
+
+static struct hmemory_copy_site * debug_copy_site_get (const char *func, const char *file, const int line)
+{
+	return (struct hmemory_copy_site *) debug_site_table_get(&hmemory_copy_sites, func, file, line);
+}
+
+/*
+ * nothing is collected while the copy report is disabled.
+ */
+static void debug_copy_add (int op, size_t len, const char *func, const char *file, const int line)
+{
+	struct hmemory_copy_site *s;
+	if (hconfig(report_copy) <= 0) {
+		return;
+	}
+	s = debug_copy_site_get(func, file, line);
+	__atomic_fetch_add(&s->calls[op], 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&s->bytes[op], len, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&s->size[debug_histogram_log2(len)], 1, __ATOMIC_RELAXED);
+}
+
+static unsigned long long debug_copy_sum (const unsigned long long *values)
+{
+	unsigned int i;
+	unsigned long long sum;
+	for (sum = 0, i = 0; i < HMEMORY_COPY_OPS; i++) {
+		sum += __atomic_load_n(&values[i], __ATOMIC_RELAXED);
+	}
+	return sum;
+}
+
+static void debug_copy_report (void)
+{
+	int v;
+	int n;
+	int j;
+	unsigned int i;
+	char buffer[256];
+	size_t length;
+	unsigned long long b;
+	unsigned long long c;
+	unsigned long long calls[HMEMORY_COPY_OPS];
+	unsigned long long bytes[HMEMORY_COPY_OPS];
+	struct hmemory_copy_site *s;
+	struct hmemory_copy_site *top[HMEMORY_COPY_TOP_MAX];
+	v = hconfig(report_copy);
+	if (v <= 0) {
+		return;
+	}
+	if (v > HMEMORY_COPY_TOP_MAX) {
+		v = HMEMORY_COPY_TOP_MAX;
+	}
+	memset(calls, 0, sizeof(calls));
+	memset(bytes, 0, sizeof(bytes));
+	for (n = 0, i = 0; i <= HMEMORY_SITE_MAX; i++) {
+		s = (struct hmemory_copy_site *) debug_site_table_at(&hmemory_copy_sites, i);
+		if (s == NULL) {
+			continue;
+		}
+		c = debug_copy_sum(s->calls);
+		if (c == 0) {
+			continue;
+		}
+		for (j = 0; j < HMEMORY_COPY_OPS; j++) {
+			calls[j] += __atomic_load_n(&s->calls[j], __ATOMIC_RELAXED);
+			bytes[j] += __atomic_load_n(&s->bytes[j], __ATOMIC_RELAXED);
+		}
+		b = debug_copy_sum(s->bytes);
+		for (j = (n < v) ? n++ : v; j > 0 && debug_copy_sum(top[j - 1]->bytes) < b; j--) {
+			if (j < v) {
+				top[j] = top[j - 1];
+			}
+		}
+		if (j < v) {
+			top[j] = s;
+		}
+	}
+	if (n == 0) {
+		return;
+	}
+	hinfof("  copies:");
+	for (j = 0; j < HMEMORY_COPY_OPS; j++) {
+		if (calls[j] != 0) {
+			hinfof("    %-7s: %llu calls, %llu bytes (%.02f mb)", hmemory_copy_ops[j], calls[j], bytes[j], ((double) bytes[j]) / (1024.00 * 1024.00));
+		}
+	}
+	hinfof("    top copy sites:");
+	for (i = 0; i < (unsigned int) n; i++) {
+		s = top[i];
+		b = debug_copy_sum(s->bytes);
+		c = debug_copy_sum(s->calls);
+		hinfof("      - %s (%s:%d): %llu bytes (%.02f mb), %llu calls, %llu bytes/call", s->key.func, s->key.file, s->key.line, b, ((double) b) / (1024.00 * 1024.00), c, b / c);
+		for (length = 0, j = 0; j < HMEMORY_COPY_OPS; j++) {
+			c = __atomic_load_n(&s->calls[j], __ATOMIC_RELAXED);
+			if (c != 0 && length < sizeof(buffer)) {
+				length += snprintf(buffer + length, sizeof(buffer) - length, "%s%s %llu/%llu", (length == 0) ? "" : ", ", hmemory_copy_ops[j], c, __atomic_load_n(&s->bytes[j], __ATOMIC_RELAXED));
+			}
+		}
+		hinfof("        calls/bytes: %s", buffer);
+		for (length = 0, j = 0; j < HMEMORY_HISTOGRAM_BUCKETS; j++) {
+			c = __atomic_load_n(&s->size[j], __ATOMIC_RELAXED);
+			if (c != 0 && length < sizeof(buffer)) {
+				length += snprintf(buffer + length, sizeof(buffer) - length, "%s<%llu: %llu", (length == 0) ? "" : ", ", (j == 0) ? 1ULL : (j >= 64) ? ~0ULL : (1ULL << j), c);
+			}
+		}
+		hinfof("        size: %s", buffer);
+	}
+}
+
+#if defined(HMEMORY_ENABLE_PROFILE) && (HMEMORY_ENABLE_PROFILE == 1)
+
+static unsigned long long debug_profile_percentile (const unsigned long long *histogram, unsigned long long count, double percentile)
+{
+	unsigned int i;
+	unsigned long long c;
+	unsigned long long t;
+	t = (unsigned long long) (count * percentile);
+	if (t == 0) {
+		t = 1;
+	}
+	for (c = 0, i = 0; i < HMEMORY_HISTOGRAM_BUCKETS; i++) {
+		c += __atomic_load_n(&histogram[i], __ATOMIC_RELAXED);
+		if (c >= t) {
+			break;
+		}
+	}
+	return (i == 0) ? 1 : (i >= 64) ? ~0ULL : (1ULL << i);
+}
+
+static void debug_profile_print (const char *name, const unsigned long long *histogram, unsigned long long calls, unsigned long long sum)
+{
+	hinfof("      %-9s: mean %llu ns, p50 < %llu ns, p90 < %llu ns, p99 < %llu ns, p99.9 < %llu ns",
+		name,
+		sum / calls,
+		debug_profile_percentile(histogram, calls, 0.50),
+		debug_profile_percentile(histogram, calls, 0.90),
+		debug_profile_percentile(histogram, calls, 0.99),
+		debug_profile_percentile(histogram, calls, 0.999));
+}
+
+static void debug_profile_report (void)
+{
+	int i;
+	int j;
+	unsigned long long l;
+	unsigned long long c;
+	unsigned long long calls;
+	unsigned long long sum;
+	struct hmemory_profile *p;
+	l = __atomic_load_n(&hmemory_profile_locks, __ATOMIC_RELAXED);
+	c = __atomic_load_n(&hmemory_profile_contended, __ATOMIC_RELAXED);
+	hinfof("  profile:");
+	hinfof("    lock: %llu acquisitions, %llu contended (%.02f%%)", l, c, (l == 0) ? 0.00 : (((double) c) * 100.00 / l));
+	for (i = 0; i < HMEMORY_PROFILE_WRAPPERS; i++) {
+		p = &hmemory_profile[i];
+		calls = __atomic_load_n(&p->calls, __ATOMIC_RELAXED);
+		if (calls == 0) {
+			continue;
+		}
+		for (sum = 0, j = 0; j < HMEMORY_PROFILE_PHASES; j++) {
+			sum += __atomic_load_n(&p->sum[j], __ATOMIC_RELAXED);
+		}
+		hinfof("    %s: %llu calls", hmemory_profile_wrappers[i], calls);
+		debug_profile_print("total", p->total, calls, sum);
+		for (j = 0; j < HMEMORY_PROFILE_PHASES; j++) {
+			debug_profile_print(hmemory_profile_phases[j], p->phase[j], calls, __atomic_load_n(&p->sum[j], __ATOMIC_RELAXED));
+		}
+	}
+}
+
+#else
+
+#define debug_profile_report()
+
+#endif
+
+static int debug_span_add (struct hmemory_memory *m)
+{
+	int rc;
+	uintptr_t r;
+	uintptr_t start;
+	uintptr_t end;
+	struct hmemory_memory **v;
+	start = (uintptr_t) m->address;
+	end = start + m->size;
+	pthread_rwlock_wrlock(&debug_span_lock);
+	v = debug_table_put_span(&debug_span_pages, start >> HMEMORY_SPAN_PAGE_SHIFT, &rc);
+	if (rc == -1) {
+		pthread_rwlock_unlock(&debug_span_lock);
+		return -1;
+	}
+	m->span = (rc == 0) ? *v : NULL;
+	m->span_prev = NULL;
+	if (m->span != NULL) {
+		m->span->span_prev = m;
+	}
+	*v = m;
+	for (r = (start >> HMEMORY_SPAN_REGION_SHIFT) + 1; r <= ((end - 1) >> HMEMORY_SPAN_REGION_SHIFT); r++) {
+		v = debug_table_put_span(&debug_span_regions, r, &rc);
+		if (rc == -1) {
+			pthread_rwlock_unlock(&debug_span_lock);
+			return -1;
+		}
+		*v = m;
+	}
+	if (start < __atomic_load_n(&debug_span_low, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&debug_span_low, start, __ATOMIC_RELAXED);
+	}
+	if (end > __atomic_load_n(&debug_span_high, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&debug_span_high, end, __ATOMIC_RELAXED);
+	}
+	pthread_rwlock_unlock(&debug_span_lock);
+	return 0;
+}
+
+static void debug_span_del (struct hmemory_memory *m)
+{
+	uintptr_t r;
+	uintptr_t start;
+	uintptr_t end;
+	struct hmemory_memory **v;
+	start = (uintptr_t) m->address;
+	end = start + m->size;
+	pthread_rwlock_wrlock(&debug_span_lock);
+	if (m->span_prev != NULL) {
+		m->span_prev->span = m->span;
+	} else {
+		v = debug_table_get_span(&debug_span_pages, start >> HMEMORY_SPAN_PAGE_SHIFT);
+		if (v != NULL && *v == m) {
+			*v = m->span;
+			if (*v == NULL) {
+				debug_table_del_span(&debug_span_pages, start >> HMEMORY_SPAN_PAGE_SHIFT);
+			}
+		}
+	}
+	if (m->span != NULL) {
+		m->span->span_prev = m->span_prev;
+	}
+	for (r = (start >> HMEMORY_SPAN_REGION_SHIFT) + 1; r <= ((end - 1) >> HMEMORY_SPAN_REGION_SHIFT); r++) {
+		v = debug_table_get_span(&debug_span_regions, r);
+		if (v != NULL && *v == m) {
+			debug_table_del_span(&debug_span_regions, r);
+		}
+	}
+	m->span = NULL;
+	m->span_prev = NULL;
+	pthread_rwlock_unlock(&debug_span_lock);
+}
+
+/*
+ * a block resized in place keeps its page chain, only the regions it
+ * covers behind its start change.
+ */
+static void debug_span_resize (struct hmemory_memory *m, size_t osize)
+{
+	int rc;
+	uintptr_t r;
+	uintptr_t first;
+	uintptr_t last;
+	uintptr_t olast;
+	uintptr_t start;
+	struct hmemory_memory **v;
+	start = (uintptr_t) m->address;
+	first = (start >> HMEMORY_SPAN_REGION_SHIFT) + 1;
+	last = (start + m->size - 1) >> HMEMORY_SPAN_REGION_SHIFT;
+	olast = (start + osize - 1) >> HMEMORY_SPAN_REGION_SHIFT;
+	pthread_rwlock_wrlock(&debug_span_lock);
+	for (r = (olast + 1 > first) ? olast + 1 : first; r <= last; r++) {
+		v = debug_table_put_span(&debug_span_regions, r, &rc);
+		if (rc == -1) {
+			break;
+		}
+		*v = m;
+	}
+	for (r = (last + 1 > first) ? last + 1 : first; r <= olast; r++) {
+		v = debug_table_get_span(&debug_span_regions, r);
+		if (v != NULL && *v == m) {
+			debug_table_del_span(&debug_span_regions, r);
+		}
+	}
+	if (start + m->size > __atomic_load_n(&debug_span_high, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&debug_span_high, start + m->size, __ATOMIC_RELAXED);
+	}
+	pthread_rwlock_unlock(&debug_span_lock);
+}
+
+static void debug_span_lock_init (void)
+{
+#if defined(__LINUX__) && (__LINUX__ == 1)
+	pthread_rwlockattr_t attr;
+	pthread_rwlockattr_init(&attr);
+	pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+	pthread_rwlock_init(&debug_span_lock, &attr);
+	pthread_rwlockattr_destroy(&attr);
+#else
+	debug_span_lock = (pthread_rwlock_t) PTHREAD_RWLOCK_INITIALIZER;
+#endif
+}
+
+static struct hmemory_memory * debug_span_page (uintptr_t page, uintptr_t address)
+{
+	struct hmemory_memory **v;
+	struct hmemory_memory *m;
+	v = debug_table_get_span(&debug_span_pages, page);
+	if (v == NULL) {
+		return NULL;
+	}
+	for (m = *v; m != NULL; m = m->span) {
+		if (address >= (uintptr_t) m->address && address < (uintptr_t) m->address + m->size) {
+			return m;
+		}
+	}
+	return NULL;
+}
+
+static struct hmemory_memory * debug_span_find (uintptr_t address)
+{
+	uintptr_t p;
+	uintptr_t first;
+	struct hmemory_memory **v;
+	struct hmemory_memory *m;
+	p = address >> HMEMORY_SPAN_PAGE_SHIFT;
+	m = debug_span_page(p, address);
+	if (m != NULL) {
+		return m;
+	}
+	v = debug_table_get_span(&debug_span_regions, address >> HMEMORY_SPAN_REGION_SHIFT);
+	if (v != NULL) {
+		m = *v;
+		if (address < (uintptr_t) m->address + m->size) {
+			return m;
+		}
+	}
+	first = (address >> HMEMORY_SPAN_REGION_SHIFT) << (HMEMORY_SPAN_REGION_SHIFT - HMEMORY_SPAN_PAGE_SHIFT);
+	while (p-- > first) {
+		m = debug_span_page(p, address);
+		if (m != NULL) {
+			return m;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * scan index, address, size and record of every tracked block in dense
+ * parallel arrays, and each record knows its slot. a removed block's slot
+ * takes the last entry. the worker check and the leak scan stream through
+ * the arrays instead of chasing records through the tables.
+ */
+#define HMEMORY_SCAN_BATCH			64
+
+struct hmemory_scan {
+	uintptr_t *address;
+	size_t *size;
+	struct hmemory_memory **memory;
+	size_t count;
+	size_t capacity;
+	size_t missing;
+};
+
+#if (HMEMORY_ARENA_RECORDS > 0)
+static uintptr_t hmemory_scan_address[HMEMORY_ARENA_RECORDS];
+static size_t hmemory_scan_size[HMEMORY_ARENA_RECORDS];
+static struct hmemory_memory *hmemory_scan_memory[HMEMORY_ARENA_RECORDS];
+static struct hmemory_scan debug_scan		= { hmemory_scan_address, hmemory_scan_size, hmemory_scan_memory, 0, HMEMORY_ARENA_RECORDS, 0 };
+#else
+static struct hmemory_scan debug_scan;
+#endif
+
+static int debug_scan_grow (void)
+{
+#if (HMEMORY_ARENA_RECORDS > 0)
+	return -1;
+#else
+	void *array;
+	size_t capacity;
+	capacity = (debug_scan.capacity == 0) ? 4096 : debug_scan.capacity * 2;
+	array = debug_metadata_realloc(debug_scan.address, capacity * sizeof(uintptr_t));
+	if (array == NULL) {
+		return -1;
+	}
+	debug_scan.address = array;
+	array = debug_metadata_realloc(debug_scan.size, capacity * sizeof(size_t));
+	if (array == NULL) {
+		return -1;
+	}
+	debug_scan.size = array;
+	array = debug_metadata_realloc(debug_scan.memory, capacity * sizeof(struct hmemory_memory *));
+	if (array == NULL) {
+		return -1;
+	}
+	debug_scan.memory = array;
+	debug_scan.capacity = capacity;
+	return 0;
+#endif
+}
+
+/*
+ * adds a block to the index, with the lock held. a block that does not fit
+ * is counted as missing, the leak scan then goes through the tables.
+ */
+static void debug_scan_add (struct hmemory_memory *m)
+{
+	if (debug_scan.count == debug_scan.capacity && debug_scan_grow() != 0) {
+		m->slot = HMEMORY_SCAN_NONE;
+		debug_scan.missing += 1;
+		return;
+	}
+	m->slot = debug_scan.count++;
+	debug_scan.address[m->slot] = (uintptr_t) m->address;
+	debug_scan.size[m->slot] = m->size;
+	debug_scan.memory[m->slot] = m;
+}
+
+static void debug_scan_del (struct hmemory_memory *m)
+{
+	size_t last;
+	if (m->slot == HMEMORY_SCAN_NONE) {
+		return;
+	}
+	last = --debug_scan.count;
+	if (m->slot != last) {
+		debug_scan.address[m->slot] = debug_scan.address[last];
+		debug_scan.size[m->slot] = debug_scan.size[last];
+		debug_scan.memory[m->slot] = debug_scan.memory[last];
+		debug_scan.memory[m->slot]->slot = m->slot;
+	}
+	m->slot = HMEMORY_SCAN_NONE;
+}
+
+static void debug_scan_update (struct hmemory_memory *m)
+{
+	if (m->slot == HMEMORY_SCAN_NONE) {
+		return;
+	}
+	debug_scan.address[m->slot] = (uintptr_t) m->address;
+	debug_scan.size[m->slot] = m->size;
+}
+
+/*
+ * large blocks, of at least hmemory_large_threshold bytes, are mapped
+ * directly and kept in a table of their own, away from the small blocks.
+ * the block starts at the same head offset as a malloc'd one, so signatures
+ * and checks are shared, and the mapping has an inaccessible guard page on
+ * each side:
+ *
+ *   guard | pad to head size | signature | user data | signature | slack | guard
+ *
+ * realloc drops the trailing guard and lets mremap grow the mapping, in
+ * place when the pages behind it are free, otherwise by moving the page
+ * tables instead of copying. the guards are then mapped again around the
+ * result, a guard whose page was taken by someone else in the meantime is
+ * left out, and the record keeps which guards the mapping owns.
+ */
+static inline size_t debug_large_pagesize (void)
+{
+	if (__builtin_expect(debug_large_page == 0, 0)) {
+		debug_large_page = sysconf(_SC_PAGESIZE);
+	}
+	return debug_large_page;
+}
+
+static inline int debug_large_wanted (size_t size)
+{
+	int threshold;
+	threshold = hconfig(large_threshold);
+	return (threshold > 0) && (size >= (size_t) threshold);
+}
+
+static inline size_t debug_large_length (size_t size)
+{
+	size_t page;
+	page = debug_large_pagesize();
+	return (hmemory_head_size - hmemory_signature_size + size + page - 1) & ~(page - 1);
+}
+
+/*
+ * returns base of a zero filled mapping for a block of size bytes, the
+ * signatures included, with both guards.
+ */
+static void * debug_large_map (size_t size)
+{
+	void *map;
+	size_t page;
+	size_t length;
+	page = debug_large_pagesize();
+	length = debug_large_length(size);
+	map = mmap(NULL, length + page * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (map == MAP_FAILED) {
+		return NULL;
+	}
+	if (mprotect(map + page, length, PROT_READ | PROT_WRITE) != 0) {
+		munmap(map, length + page * 2);
+		return NULL;
+	}
+	return map + page;
+}
+
+static void debug_large_unmap (void *base, size_t size, int large)
+{
+	size_t page;
+	size_t length;
+	page = debug_large_pagesize();
+	length = debug_large_length(size);
+	if (large & HMEMORY_LARGE_HEAD) {
+		base -= page;
+		length += page;
+	}
+	if (large & HMEMORY_LARGE_TAIL) {
+		length += page;
+	}
+	munmap(base, length);
+}
+
+static int debug_large_guard (void *address)
+{
+	void *rc;
+	size_t page;
+	page = debug_large_pagesize();
+	rc = mmap(address, page, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	if (rc == address) {
+		return 1;
+	}
+	if (rc != MAP_FAILED) {
+		munmap(rc, page);
+	}
+	return 0;
+}
+
+/*
+ * resizes the mapping of a detached large block to size bytes, the
+ * signatures included, returns the new base and updates the guards the
+ * record owns.
+ */
+static void * debug_large_remap (struct hmemory_memory *m, size_t size)
+{
+	void *rc;
+	size_t page;
+	size_t olength;
+	size_t length;
+	page = debug_large_pagesize();
+	olength = debug_large_length(m->size);
+	length = debug_large_length(size);
+	if (length == olength) {
+		return m->base;
+	}
+	if (length < olength) {
+		if (mprotect(m->base + length, page, PROT_NONE) != 0) {
+			return NULL;
+		}
+		munmap(m->base + length + page, olength - length - page + ((m->large & HMEMORY_LARGE_TAIL) ? page : 0));
+		m->large |= HMEMORY_LARGE_TAIL;
+		return m->base;
+	}
+	if (m->large & HMEMORY_LARGE_TAIL) {
+		munmap(m->base + olength, page);
+		m->large &= ~HMEMORY_LARGE_TAIL;
+	}
+	rc = mremap(m->base, olength, length, MREMAP_MAYMOVE);
+	if (rc == MAP_FAILED) {
+		if (debug_large_guard(m->base + olength)) {
+			m->large |= HMEMORY_LARGE_TAIL;
+		}
+		return NULL;
+	}
+	if (rc != m->base && (m->large & HMEMORY_LARGE_HEAD)) {
+		munmap(m->base - page, page);
+		m->large &= ~HMEMORY_LARGE_HEAD;
+	}
+	if (!(m->large & HMEMORY_LARGE_HEAD) && debug_large_guard(rc - page)) {
+		m->large |= HMEMORY_LARGE_HEAD;
+	}
+	if (debug_large_guard(rc + length)) {
+		m->large |= HMEMORY_LARGE_TAIL;
+	}
+	return rc;
+}
+
+/*
+ * lookup in the large table, with the lock held. only blocks whose base is
+ * page aligned can be large, other addresses skip the table.
+ */
+static inline struct hmemory_memory * debug_large_get (void *address)
+{
+	struct hmemory_memory **v;
+	if (debug_table_size(&debug_large) == 0 ||
+	    (((uintptr_t) address - (hmemory_head_size - hmemory_signature_size)) & (debug_large_pagesize() - 1)) != 0) {
+		return NULL;
+	}
+	v = debug_table_get_large(&debug_large, address);
+	if (v == NULL) {
+		return NULL;
+	}
+	return *v;
+}
+
+static inline int debug_large_put (struct hmemory_memory *m)
+{
+	int rc;
+	struct hmemory_memory **v;
+	v = debug_table_put_large(&debug_large, m->address, &rc);
+	if (rc == -1) {
+		return -1;
+	}
+	*v = m;
+	return 0;
+}
+
+static inline void debug_large_del (struct hmemory_memory *m)
+{
+	debug_table_del_large(&debug_large, m->address);
+}
+
+static inline int debug_memory_large (struct hmemory_memory *m)
+{
+	return m->large;
+}
+
+static inline size_t debug_memory_count (void)
+{
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+	return HASH_COUNT(debug_memory) + debug_table_size(&debug_large);
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	return debug_table_size(&debug_memory) + debug_table_size(&debug_large);
+#endif
+}
+
+/*
+ * suppressions, read from the file named by hmemory_suppressions, one rule
+ * per line:
+ *
+ *   leak|error func|file|site:pattern
+ *
+ * leak rules match the allocation site of blocks left on exit, error rules
+ * the call site an error is reported at. site is "file:line". patterns are
+ * fnmatch globs, those without wildcards are kept in per field hash sets,
+ * and the outcome for a site is cached, so a rule costs one lookup per site
+ * however many blocks or errors there are.
+ */
+enum {
+	HMEMORY_SUPPRESS_LEAK,
+	HMEMORY_SUPPRESS_ERROR,
+	HMEMORY_SUPPRESS_TYPES
+};
+
+enum {
+	HMEMORY_SUPPRESS_FUNC,
+	HMEMORY_SUPPRESS_FILE,
+	HMEMORY_SUPPRESS_SITE,
+	HMEMORY_SUPPRESS_FIELDS
+};
+
+static const char *hmemory_suppress_types[HMEMORY_SUPPRESS_TYPES] = {
+	"leak",
+	"error",
+};
+
+static const char *hmemory_suppress_fields[HMEMORY_SUPPRESS_FIELDS] = {
+	"func",
+	"file",
+	"site",
+};
+
+#define HMEMORY_SUPPRESS_CACHE			1024
+
+struct hmemory_suppression {
+	int type;
+	int field;
+	char *pattern;
+	unsigned long long hits;
+	unsigned long long bytes;
+	struct hmemory_suppression *next;
+	struct hmemory_suppression *same;
+};
+
+struct hmemory_suppress_cache {
+	const char *func;
+	const char *file;
+	int line;
+	int type;
+	struct hmemory_suppression *rule;
+};
+
+KHASH_MAP_INIT_STR(suppress, struct hmemory_suppression *);
+
+static struct hmemory_suppression *hmemory_suppressions;
+static struct hmemory_suppression **hmemory_suppress_tail = &hmemory_suppressions;
+static struct hmemory_suppression *hmemory_suppress_globs;
+static struct hmemory_suppression **hmemory_suppress_globs_tail = &hmemory_suppress_globs;
+static khash_t(suppress) *hmemory_suppress_exact[HMEMORY_SUPPRESS_FIELDS];
+static struct hmemory_suppress_cache hmemory_suppress_cache[HMEMORY_SUPPRESS_CACHE];
+static pthread_mutex_t hmemory_suppress_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int debug_suppress_rule (char *line)
+{
+	int ret;
+	int type;
+	int field;
+	char *p;
+	char *e;
+	khiter_t k;
+	struct hmemory_suppression *s;
+	p = line + strspn(line, " \t");
+	e = p + strcspn(p, "\r\n");
+	*e = '\0';
+	if (*p == '\0' || *p == '#') {
+		return 0;
+	}
+	for (type = 0; type < HMEMORY_SUPPRESS_TYPES; type++) {
+		if (strncmp(p, hmemory_suppress_types[type], strlen(hmemory_suppress_types[type])) == 0 &&
+		    strchr(" \t", p[strlen(hmemory_suppress_types[type])]) != NULL) {
+			break;
+		}
+	}
+	if (type == HMEMORY_SUPPRESS_TYPES) {
+		return -1;
+	}
+	p += strlen(hmemory_suppress_types[type]);
+	p += strspn(p, " \t");
+	for (field = 0; field < HMEMORY_SUPPRESS_FIELDS; field++) {
+		if (strncmp(p, hmemory_suppress_fields[field], strlen(hmemory_suppress_fields[field])) == 0 &&
+		    p[strlen(hmemory_suppress_fields[field])] == ':') {
+			break;
+		}
+	}
+	if (field == HMEMORY_SUPPRESS_FIELDS) {
+		return -1;
+	}
+	p += strlen(hmemory_suppress_fields[field]) + 1;
+	while (e > p && (e[-1] == ' ' || e[-1] == '\t')) {
+		*--e = '\0';
+	}
+	if (*p == '\0') {
+		return -1;
+	}
+	s = calloc(1, sizeof(struct hmemory_suppression) + strlen(p) + 1);
+	if (s == NULL) {
+		return -1;
+	}
+	s->type = type;
+	s->field = field;
+	s->pattern = (char *) (s + 1);
+	strcpy(s->pattern, p);
+	*hmemory_suppress_tail = s;
+	hmemory_suppress_tail = &s->next;
+	if (strpbrk(s->pattern, "*?[") != NULL) {
+		*hmemory_suppress_globs_tail = s;
+		hmemory_suppress_globs_tail = &s->same;
+		return 0;
+	}
+	k = kh_put(suppress, hmemory_suppress_exact[field], s->pattern, &ret);
+	if (ret < 0) {
+		return -1;
+	}
+	s->same = (ret == 0) ? kh_val(hmemory_suppress_exact[field], k) : NULL;
+	kh_val(hmemory_suppress_exact[field], k) = s;
+	return 0;
+}
+
+static void debug_suppress_init (void)
+{
+	int n;
+	FILE *fp;
+	char line[1024];
+	const char *path;
+	path = hconfig(suppressions);
+	if (*path == '\0') {
+		return;
+	}
+	fp = fopen(path, "r");
+	if (fp == NULL) {
+		herrorf("can not open suppressions file %s", path);
+		return;
+	}
+	for (n = 0; n < HMEMORY_SUPPRESS_FIELDS; n++) {
+		hmemory_suppress_exact[n] = kh_init(suppress);
+	}
+	for (n = 1; fgets(line, sizeof(line), fp) != NULL; n++) {
+		if (debug_suppress_rule(line) != 0) {
+			herrorf("invalid suppression at %s:%d", path, n);
+		}
+	}
+	fclose(fp);
+}
+
+static struct hmemory_suppression * debug_suppress_match (int type, const char *func, const char *file, const int line)
+{
+	int f;
+	khiter_t k;
+	char site[512];
+	const char *values[HMEMORY_SUPPRESS_FIELDS];
+	struct hmemory_suppression *s;
+	values[HMEMORY_SUPPRESS_FUNC] = (func == NULL) ? "" : func;
+	values[HMEMORY_SUPPRESS_FILE] = (file == NULL) ? "" : file;
+	snprintf(site, sizeof(site), "%s:%d", values[HMEMORY_SUPPRESS_FILE], line);
+	values[HMEMORY_SUPPRESS_SITE] = site;
+	for (f = 0; f < HMEMORY_SUPPRESS_FIELDS; f++) {
+		k = kh_get(suppress, hmemory_suppress_exact[f], values[f]);
+		if (k == kh_end(hmemory_suppress_exact[f])) {
+			continue;
+		}
+		for (s = kh_val(hmemory_suppress_exact[f], k); s != NULL; s = s->same) {
+			if (s->type == type) {
+				return s;
+			}
+		}
+	}
+	for (s = hmemory_suppress_globs; s != NULL; s = s->same) {
+		if (s->type == type && fnmatch(s->pattern, values[s->field], 0) == 0) {
+			return s;
+		}
+	}
+	return NULL;
+}
+
+/*
+ * returns the rule suppressing type at func, file and line, or NULL. hits
+ * are counted by the caller.
+ */
+static struct hmemory_suppression * debug_suppress_find (int type, const char *func, const char *file, const int line)
+{
+	uintptr_t h;
+	struct hmemory_suppression *s;
+	struct hmemory_suppress_cache *c;
+	if (hmemory_suppressions == NULL) {
+		return NULL;
+	}
+	h = ((uintptr_t) func * 31 + (uintptr_t) file) * 31 + (unsigned int) line * 2 + type;
+	c = &hmemory_suppress_cache[((h ^ (h >> 17)) * 2654435761U >> 8) & (HMEMORY_SUPPRESS_CACHE - 1)];
+	pthread_mutex_lock(&hmemory_suppress_mutex);
+	if (c->func == func && c->file == file && c->line == line && c->type == type && c->func != NULL) {
+		s = c->rule;
+	} else {
+		s = debug_suppress_match(type, func, file, line);
+		c->func = func;
+		c->file = file;
+		c->line = line;
+		c->type = type;
+		c->rule = s;
+	}
+	pthread_mutex_unlock(&hmemory_suppress_mutex);
+	return s;
+}
+
+static int debug_suppressed (const char *func, const char *file, const int line)
+{
+	struct hmemory_suppression *s;
+	s = debug_suppress_find(HMEMORY_SUPPRESS_ERROR, func, file, line);
+	if (s == NULL) {
+		return 0;
+	}
+	__atomic_fetch_add(&s->hits, 1, __ATOMIC_RELAXED);
+	return 1;
+}
+
+static void debug_suppress_report (void)
+{
+	unsigned int n;
+	struct hmemory_suppression *s;
+	if (hmemory_suppressions == NULL) {
+		return;
+	}
+	for (n = 0, s = hmemory_suppressions; s != NULL; s = s->next) {
+		n++;
+	}
+	hinfof("  suppressions: %u rules", n);
+	for (s = hmemory_suppressions; s != NULL; s = s->next) {
+		if (s->type == HMEMORY_SUPPRESS_LEAK) {
+			hinfof("    - %s %s:%s: %llu blocks, %llu bytes%s", hmemory_suppress_types[s->type], hmemory_suppress_fields[s->field], s->pattern, s->hits, s->bytes, (s->hits == 0) ? ", unused" : "");
+		} else {
+			hinfof("    - %s %s:%s: %llu errors%s", hmemory_suppress_types[s->type], hmemory_suppress_fields[s->field], s->pattern, s->hits, (s->hits == 0) ? ", unused" : "");
+		}
+	}
+}
+
+#if !defined(HMEMORY_PRELOAD) || (HMEMORY_PRELOAD == 0)
+
+static void debug_suppress_fini (void)
+{
+	int f;
+	struct hmemory_suppression *s;
+	struct hmemory_suppression *n;
+	for (f = 0; f < HMEMORY_SUPPRESS_FIELDS; f++) {
+		if (hmemory_suppress_exact[f] != NULL) {
+			kh_destroy(suppress, hmemory_suppress_exact[f]);
+			hmemory_suppress_exact[f] = NULL;
+		}
+	}
+	for (s = hmemory_suppressions; s != NULL; s = n) {
+		n = s->next;
+		free(s);
+	}
+	hmemory_suppressions = NULL;
+	hmemory_suppress_tail = &hmemory_suppressions;
+	hmemory_suppress_globs = NULL;
+	hmemory_suppress_globs_tail = &hmemory_suppress_globs;
+}
+
+#endif
+
+/*
+ * reports accesses of [address, address + len) that start inside a tracked
+ * block and do not stay within its user data, before they happen. addresses
+ * outside tracked blocks (stack, globals, untracked memory) are not checked.
+ */
+static int debug_memory_bounds (const void *address, size_t len, const char *what, const char *command, const char *func, const char *file, const int line)
+{
+	const char *mfunc;
+	const char *mfile;
+	int mline;
+	uintptr_t start;
+	uintptr_t end;
+	uintptr_t a;
+	struct hmemory_memory *m;
+	hprofile_phase_scope(CHECK);
+	a = (uintptr_t) address;
+	if (len == 0 ||
+	    a < __atomic_load_n(&debug_span_low, __ATOMIC_RELAXED) ||
+	    a >= __atomic_load_n(&debug_span_high, __ATOMIC_RELAXED)) {
+		return 0;
+	}
+	if (pthread_rwlock_rdlock(&debug_span_lock) != 0) {
+		return 0;
+	}
+	m = (a < __atomic_load_n(&debug_span_high, __ATOMIC_RELAXED)) ? debug_span_find(a) : NULL;
+	if (m == NULL) {
+		pthread_rwlock_unlock(&debug_span_lock);
+		return 0;
+	}
+	start = (uintptr_t) m->address + hmemory_signature_size;
+	end = (uintptr_t) m->address + m->size - hmemory_signature_size;
+	if (a >= start && len <= end - a) {
+		pthread_rwlock_unlock(&debug_span_lock);
+		return 0;
+	}
+	mfunc = m->func;
+	mfile = m->file;
+	mline = m->line;
+	pthread_rwlock_unlock(&debug_span_lock);
+	if (debug_suppressed(func, file, line)) {
+		return 0;
+	}
+	hdebug_lock();
+	hinfof("%s with out of bounds %s (%p), %zu bytes at offset %lld of %zu bytes block", command, what, address, len, (long long) (a - start), (size_t) (end - start));
+	hinfof("    at: %s (%s:%d)", func, file, line);
+	debug_dump_callstack("       ");
+	hinfof("    allocated at: %s (%s:%d)", mfunc, mfile, mline);
+	hdebug_unlock();
+	hassert(0 && "out of bounds");
+	return -1;
+}
+
+static int debug_memory_add (const char *name, int kind, int large, void *base, void *address, size_t size, const char *command, const char *func, const char *file, const int line)
+{
+	int rc;
+	struct hmemory_site *site;
+	struct hmemory_memory *m;
+#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	struct hmemory_memory **v;
+#endif
+	hprofile_phase_scope(TRACKER);
+	if (address == NULL) {
+		return 0;
+	}
+	hmemory_lock();
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+	HASH_FIND_PTR(debug_memory, &address, m);
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	v = debug_table_get_memory(&debug_memory, address);
+	m = (v == NULL) ? NULL : *v;
+#endif
+	if (m == NULL) {
+		m = debug_large_get(address);
+	}
+	if (m != NULL) {
+		hdebug_lock();
+		hinfof("%s with invalid memory (%p)", command, address);
+		hinfof("    at: %s (%s:%d)", func, file, line);
+		hinfof("  ");
+		hinfof("  if it is certain that program is memory bug free, then hmemory");
+		hinfof("  may have a serious bug that needs to be fixed urgent. please ");
+		hinfof("  inform author");
+		hinfof("    at: alper.akcan@gmail.com");
+		hdebug_unlock();
+		hassert((m == NULL) && "invalid memory");
+		hmemory_unlock();
+		return -1;
+	}
+	m = debug_memory_alloc(name);
+	if (m == NULL) {
+		debug_arena_untrack(base, address, size, large, command, func, file, line);
+		hmemory_unlock();
+		return -1;
+	}
+	m->base = base;
+	m->address = address;
+	m->kind = kind;
+	m->large = large;
+	m->size = size;
+	m->func = func;
+	m->file = file;
+	m->line = line;
+	m->site = debug_site_get(func, file, line);
+	m->time = debug_getclock_ns();
+	memcpy(m->address, &hmemory_signature, hmemory_signature_size);
+	memcpy(m->address + m->size - hmemory_signature_size, &hmemory_signature, hmemory_signature_size);
+	if (large) {
+		rc = debug_large_put(m);
+	} else {
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+		HASH_ADD_PTR(debug_memory, address, m);
+		rc = 0;
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+		v = debug_table_put_memory(&debug_memory, address, &rc);
+		if (rc != -1) {
+			*v = m;
+		}
+#endif
+	}
+	if (rc == -1) {
+		hdebug_lock();
+		hinfof("%s with invalid memory (%p)", command, address);
+		hinfof("    at: %s (%s:%d)", func, file, line);
+		hinfof("  ");
+		hinfof("  if it is certain that program is memory bug free, then hmemory");
+		hinfof("  may have a serious bug that needs to be fixed urgent. please ");
+		hinfof("  inform author");
+		hinfof("    at: alper.akcan@gmail.com");
+		hdebug_unlock();
+		hassert((rc != -1) && "invalid memory key");
+		debug_memory_free(m);
+		debug_arena_untrack(base, address, size, large, command, func, file, line);
+		hmemory_unlock();
+		return -1;
+	}
+	debug_span_add(m);
+	debug_scan_add(m);
+	hdebugf("%s added memory: %s, address: %p, size: %zd, func: %s, file: %s, line: %d", command, m->name, m->address, m->size, m->func, m->file, m->line);
+	site = m->site;
+	hmemory_unlock();
+	debug_statistics_add(size - (hmemory_signature_size * 2));
+	debug_histogram_add(site, size - (hmemory_signature_size * 2));
+	return 0;
+}
+
+static int debug_memory_verify (struct hmemory_memory *m, void *address, const char *command, const char *func, const char *file, const int line);
+
+static int debug_memory_check_actual (void *address, const char *command, const char *func, const char *file, const int line)
+{
+	struct hmemory_memory *m;
+#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	struct hmemory_memory **v;
+#endif
+	if (address == NULL) {
+		return 0;
+	}
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+	HASH_FIND_PTR(debug_memory, &address, m);
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	v = debug_table_get_memory(&debug_memory, address);
+	m = (v == NULL) ? NULL : *v;
+#endif
+	if (m == NULL) {
+		m = debug_large_get(address);
+	}
+	if (m != NULL) {
+		goto found_m;
+	}
+	if (debug_arena_untracked(address, NULL, NULL, NULL)) {
+		return 0;
+	}
+	if (debug_suppressed(func, file, line)) {
+		return -1;
+	}
+	hdebug_lock();
+	hinfof("%s with invalid address (%p)", command, address);
+	hinfof("    at: %s (%s:%d)", func, file, line);
+	debug_dump_callstack("       ");
+	hinfof("  ");
+	hinfof("  if it is certain that program is memory bug free, then hmemory");
+	hinfof("  may have a serious bug that needs to be fixed urgent. please ");
+	hinfof("  inform author");
+	hinfof("    at: alper.akcan@gmail.com");
+	hdebug_unlock();
+	hassert((m != NULL) && "invalid address");
+	return -1;
+found_m:
+	return debug_memory_verify(m, address, command, func, file, line);
+}
+
+static int debug_memory_verify (struct hmemory_memory *m, void *address, const char *command, const char *func, const char *file, const int line)
+{
+	int rcu;
+	int rco;
+	rcu = memcmp(m->address, &hmemory_signature, hmemory_signature_size);
+	rco = memcmp(m->address + m->size - hmemory_signature_size, &hmemory_signature, hmemory_signature_size);
+	if ((rcu == 0 && rco == 0) || debug_suppressed(func, file, line)) {
+		return 0;
+	}
+	hdebug_lock();
+	if (rcu != 0) {
+		hinfof("%s with corrupted address (%p), underflow", command, address);
+		hinfof("    at: %s (%s:%d)", func, file, line);
+		debug_dump_callstack("       ");
+	}
+	if (rco != 0) {
+		hinfof("%s with corrupted address (%p), overflow", command, address);
+		hinfof("    at: %s (%s:%d)", func, file, line);
+		debug_dump_callstack("       ");
+	}
+	hdebug_unlock();
+	hassert(((rcu == 0) && (rco == 0)) && "memory corruption");
+	return 0;
+}
+
+/*
+ * returns a mask of the entries in [i, i + n) of the scan index whose head
+ * or tail signature differs, n is at most HMEMORY_SCAN_BATCH. the loop
+ * is branch free over the packed address and size arrays.
+ */
+static inline uint64_t debug_scan_batch (size_t i, size_t n)
+{
+	size_t j;
+	uint64_t bad;
+	intptr_t head;
+	intptr_t tail;
+	bad = 0;
+	for (j = 0; j < n; j++) {
+		memcpy(&head, (void *) debug_scan.address[i + j], sizeof(head));
+		memcpy(&tail, (void *) (debug_scan.address[i + j] + debug_scan.size[i + j] - hmemory_signature_size), sizeof(tail));
+		bad |= ((uint64_t) ((head != hmemory_signature) | (tail != hmemory_signature))) << j;
+	}
+	return bad;
+}
+
+/*
+ * checks the signatures of every tracked block, with the lock held. the
+ * signatures of the next batch are prefetched while the current one is
+ * compared, and only blocks of a failing batch entry are looked at through
+ * their records.
+ */
+static void debug_scan_check (const char *command, const char *func, const char *file, const int line)
+{
+	size_t i;
+	size_t j;
+	size_t n;
+	uint64_t bad;
+	struct hmemory_memory *m;
+	for (i = 0; i < debug_scan.count; i += n) {
+		n = debug_scan.count - i;
+		if (n > HMEMORY_SCAN_BATCH) {
+			n = HMEMORY_SCAN_BATCH;
+		}
+		for (j = i + n; j < i + n + HMEMORY_SCAN_BATCH && j < debug_scan.count; j++) {
+			__builtin_prefetch((void *) debug_scan.address[j]);
+			__builtin_prefetch((void *) (debug_scan.address[j] + debug_scan.size[j] - hmemory_signature_size));
+		}
+		for (bad = debug_scan_batch(i, n); bad != 0; bad &= bad - 1) {
+			m = debug_scan.memory[i + __builtin_ctzll(bad)];
+			debug_memory_verify(m, m->address, command, func, file, line);
+		}
+	}
+}
+
+static int debug_memory_check (void *address, const char *command, const char *func, const char *file, const int line)
+{
+	hprofile_phase_scope(CHECK);
+	hmemory_lock();
+	debug_memory_check_actual(address, command, func, file, line);
+	hmemory_unlock();
+	return 0;
+}
+
+static int debug_memory_find (void *address, void **base, size_t *size, int *kind)
+{
+	int rc;
+	struct hmemory_memory *m;
+#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	struct hmemory_memory **v;
+#endif
+	if (hmemory_lock() == EDEADLK) {
+		return -1;
+	}
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+	HASH_FIND_PTR(debug_memory, &address, m);
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	v = debug_table_get_memory(&debug_memory, address);
+	m = (v == NULL) ? NULL : *v;
+#endif
+	if (m == NULL) {
+		m = debug_large_get(address);
+	}
+	if (m == NULL) {
+		rc = debug_arena_untracked(address, base, size, NULL) ? 0 : -1;
+		if (rc == 0 && kind != NULL) {
+			*kind = HMEMORY_KIND_MALLOC;
+		}
+		hmemory_unlock();
+		return rc;
+	}
+	if (base != NULL) {
+		*base = m->base;
+	}
+	if (size != NULL) {
+		*size = m->size;
+	}
+	if (kind != NULL) {
+		*kind = m->kind;
+	}
+	hmemory_unlock();
+	return 0;
+}
+
+static int debug_memory_overlap (void *s1, const void *s2, size_t len, const char *command, const char *func, const char *file, const int line)
+{
+	void *e1;
+	const void *e2;
+	hprofile_phase_scope(CHECK);
+	e1 = s1 + len;
+	e2 = s2 + len;
+	if (s2 < e1 && s1 < e2 && !debug_suppressed(func, file, line)) {
+		hdebug_lock();
+		hinfof("%s with overlapping memory", command);
+		hinfof("    at: %s (%s:%d)", func, file, line);
+		debug_dump_callstack("       ");
+		hdebug_unlock();
+		hassert(((e1 <= s2) || (e2 <= s1)) && "memory overlap");
+	}
+	return 0;
+}
+
+/*
+ * verifies and removes the record of a block with a single lookup, and
+ * returns its large mapping kind or -1 for an invalid address. when
+ * preloaded, addresses that were handed out untracked belong to the next
+ * allocator and -2 is returned for them without a report.
+ */
+static int debug_memory_del (void *address, int kind, size_t length, void **base, size_t *size, const char *command, const char *func, const char *file, const int line)
+{
+#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	struct hmemory_memory **v;
+#endif
+	int large;
+	size_t bytes;
+	unsigned long long time;
+	struct hmemory_site *site;
+	struct hmemory_memory *m;
+	hprofile_phase_scope(TRACKER);
+	if (address == NULL) {
+		return 0;
+	}
+	hmemory_lock();
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+	HASH_FIND_PTR(debug_memory, &address, m);
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	v = debug_table_get_memory(&debug_memory, address);
+	m = (v == NULL) ? NULL : *v;
+#endif
+	if (m == NULL) {
+		m = debug_large_get(address);
+	}
+	if (m != NULL) {
+		goto found_m;
+	}
+	if (debug_arena_untracked(address, base, &bytes, &large)) {
+		debug_arena_release(address, bytes);
+		if (size != NULL) {
+			*size = bytes;
+		}
+		hmemory_unlock();
+		return large;
+	}
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+	if (debug_preload_passed(address + hmemory_signature_size)) {
+		hmemory_unlock();
+		return -2;
+	}
+#endif
+	if (debug_suppressed(func, file, line)) {
+		hmemory_unlock();
+		return -1;
+	}
+	hdebug_lock();
+	hinfof("%s with invalid address (%p)", command, address);
+	hinfof("    at: %s (%s:%d)", func, file, line);
+	debug_dump_callstack("       ");
+	hinfof("  ");
+	hinfof("  if it is certain that program is memory bug free, then hmemory");
+	hinfof("  may have a serious bug that needs to be fixed urgent. please ");
+	hinfof("  inform author");
+	hinfof("    at: alper.akcan@gmail.com");
+	hdebug_unlock();
+	hassert((m != NULL) && "invalid address");
+	hmemory_unlock();
+	return -1;
+found_m:
+	debug_memory_verify(m, address, command, func, file, line);
+	if (m->kind != kind && !debug_suppressed(func, file, line)) {
+		hdebug_lock();
+		hinfof("%s with mismatched memory (%p), allocated with %s", command, address, hmemory_kinds[m->kind]);
+		hinfof("    at: %s (%s:%d)", func, file, line);
+		debug_dump_callstack("       ");
+		hinfof("    allocated at: %s (%s:%d)", m->func, m->file, m->line);
+		hdebug_unlock();
+		hassert((m->kind == kind) && "mismatched free");
+	} else if (length != 0 && m->size - (hmemory_signature_size * 2) != length && !debug_suppressed(func, file, line)) {
+		hdebug_lock();
+		hinfof("%s with mismatched size (%p), %zd bytes instead of %zd", command, address + hmemory_signature_size, length, m->size - (hmemory_signature_size * 2));
+		hinfof("    at: %s (%s:%d)", func, file, line);
+		debug_dump_callstack("       ");
+		hinfof("    allocated at: %s (%s:%d)", m->func, m->file, m->line);
+		hdebug_unlock();
+		hassert(0 && "mismatched size");
+	}
+	if (m->large) {
+		debug_large_del(m);
+	} else {
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+		HASH_DEL(debug_memory, m);
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+		debug_table_del_memory(&debug_memory, m->address);
+#endif
+	}
+	debug_span_del(m);
+	debug_scan_del(m);
+	hdebugf("%s deleted memory: %s, address: %p, size: %zd, func: %s, file: %s, line: %d", command, m->name, m->address, m->size, m->func, m->file, m->line);
+	if (base != NULL) {
+		*base = m->base;
+	}
+	if (size != NULL) {
+		*size = m->size;
+	}
+	bytes = m->size - (hmemory_signature_size * 2);
+	site = m->site;
+	time = m->time;
+	large = m->large;
+	debug_memory_free(m);
+	hmemory_unlock();
+	debug_statistics_del(bytes);
+	debug_histogram_del(site, time);
+	return large;
+}
+
+/*
+ * realloc keeps the record of the block instead of dropping and recreating
+ * it. the record is looked up once and the block is resized with the lock
+ * held, so no other thread sees it between the old and the new size. a
+ * block that stays at its address is updated where it is, only a block
+ * that moved is taken out of the tables and put back under the new key.
+ * returns the record, its base and size with the lock held, or NULL with
+ * the lock released.
+ */
+static struct hmemory_memory * debug_memory_acquire (void *address, int kind, void **base, size_t *size, const char *command, const char *func, const char *file, const int line)
+{
+#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	struct hmemory_memory **v;
+#endif
+	struct hmemory_memory *m;
+	hprofile_phase_scope(TRACKER);
+	hmemory_lock();
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+	HASH_FIND_PTR(debug_memory, &address, m);
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	v = debug_table_get_memory(&debug_memory, address);
+	m = (v == NULL) ? NULL : *v;
+#endif
+	if (m == NULL) {
+		m = debug_large_get(address);
+	}
+	if (m == NULL) {
+		debug_memory_check_actual(address, command, func, file, line);
+		hmemory_unlock();
+		return NULL;
+	}
+	debug_memory_verify(m, address, command, func, file, line);
+	if (m->kind != kind && !debug_suppressed(func, file, line)) {
+		hdebug_lock();
+		hinfof("%s with mismatched memory (%p), allocated with %s", command, address, hmemory_kinds[m->kind]);
+		hinfof("    at: %s (%s:%d)", func, file, line);
+		debug_dump_callstack("       ");
+		hinfof("    allocated at: %s (%s:%d)", m->func, m->file, m->line);
+		hdebug_unlock();
+		hassert((m->kind == kind) && "mismatched free");
+	}
+	*base = m->base;
+	*size = m->size;
+	return m;
+}
+
+/*
+ * the block was resized by the real realloc, which carried the head
+ * signature along, so only the tail signature needs writing and only when
+ * the size changed. accounting matches a free of the old block followed by
+ * an allocation of the new one at the realloc site. called with the lock
+ * held and releases it. a moved block that cannot be put back under its
+ * new key is freed along with its record.
+ */
+static int debug_memory_resize (struct hmemory_memory *m, void *base, void *address, size_t size, const char *func, const char *file, const int line)
+{
+	int rc;
+	int large;
+	size_t osize;
+	struct hmemory_site *site;
+	struct hmemory_site *osite;
+	unsigned long long otime;
+#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	struct hmemory_memory **v;
+#endif
+	hprofile_phase_scope(TRACKER);
+	rc = 0;
+	osize = m->size;
+	osite = m->site;
+	otime = m->time;
+	if (address != m->address) {
+		if (m->large) {
+			debug_large_del(m);
+		} else {
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+			HASH_DEL(debug_memory, m);
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+			debug_table_del_memory(&debug_memory, m->address);
+#endif
+		}
+		debug_span_del(m);
+		m->address = address;
+		m->size = size;
+		if (m->large) {
+			rc = debug_large_put(m);
+		} else {
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+			HASH_ADD_PTR(debug_memory, address, m);
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+			v = debug_table_put_memory(&debug_memory, address, &rc);
+			if (rc != -1) {
+				*v = m;
+			}
+#endif
+		}
+		if (rc != -1) {
+			debug_span_add(m);
+		}
+	} else if (size != osize) {
+		m->size = size;
+		debug_span_resize(m, osize);
+	}
+	m->base = base;
+	if (rc == -1) {
+		hdebug_lock();
+		hinfof("realloc with invalid memory (%p)", address);
+		hinfof("    at: %s (%s:%d)", func, file, line);
+		hdebug_unlock();
+		hassert((rc != -1) && "invalid memory key");
+		large = m->large;
+		debug_scan_del(m);
+		debug_memory_free(m);
+		hmemory_unlock();
+		if (large) {
+			hprofile_phase(ALLOCATOR, debug_large_unmap(base, size, large));
+		} else {
+			hprofile_phase(ALLOCATOR, free(base));
+		}
+		debug_statistics_del(osize - (hmemory_signature_size * 2));
+		debug_histogram_del(osite, otime);
+		return -1;
+	}
+	debug_scan_update(m);
+	m->func = func;
+	m->file = file;
+	m->line = line;
+	m->site = debug_site_get(func, file, line);
+	m->time = debug_getclock_ns();
+	if (size != osize) {
+		memcpy(address + size - hmemory_signature_size, &hmemory_signature, hmemory_signature_size);
+	}
+	hdebugf("realloc updated memory: %s, address: %p, size: %zd, func: %s, file: %s, line: %d", m->name, m->address, m->size, m->func, m->file, m->line);
+	site = m->site;
+	hmemory_unlock();
+	debug_statistics_del(osize - (hmemory_signature_size * 2));
+	debug_histogram_del(osite, otime);
+	debug_statistics_add(size - (hmemory_signature_size * 2));
+	debug_histogram_add(site, size - (hmemory_signature_size * 2));
+	return 0;
+}
+
+/*
+ * conservative reachability scan of the blocks still tracked on exit.
+ * writable mappings of /proc/self/maps (data, bss, heap outside tracked
+ * blocks, thread stacks) are roots, the stack of the calling thread only
+ * above its frame, with callee saved registers spilled into it. any aligned
+ * word pointing into the user data of a block marks it still reachable,
+ * and reachable blocks are scanned in turn. roots are cut into chunks that
+ * worker threads take in order, each thread then scans the blocks it
+ * marked. blocks left unmarked are lost, a lost block that is pointed to
+ * by another lost block is indirectly lost, the rest are definitely lost;
+ * of a cycle of lost blocks the first one found is definitely lost.
+ *
+ * the block table and worker stacks hold block addresses, so they are
+ * mapped outside the heap and excluded from the roots.
+ */
+enum {
+	HMEMORY_LEAK_UNKNOWN,
+	HMEMORY_LEAK_REACHABLE,
+	HMEMORY_LEAK_INDIRECT,
+	HMEMORY_LEAK_DEFINITE,
+	HMEMORY_LEAK_STATES
+};
+
+static const char *hmemory_leak_states[HMEMORY_LEAK_STATES] = {
+	"unknown",
+	"still reachable",
+	"indirectly lost",
+	"definitely lost",
+};
+
+#define HMEMORY_LEAK_CHUNK			(1024 * 1024)
+#define HMEMORY_LEAK_STACK			(256 * 1024)
+#define HMEMORY_LEAK_THREADS_MAX		16
+#define HMEMORY_LEAK_EXCLUDE_MAX		(HMEMORY_LEAK_THREADS_MAX + 4)
+
+struct hmemory_leak_block {
+	uintptr_t base;
+	uintptr_t start;
+	uintptr_t end;
+	struct hmemory_memory *memory;
+};
+
+struct hmemory_leak_range {
+	uintptr_t start;
+	uintptr_t end;
+};
+
+struct hmemory_leak {
+	struct hmemory_leak_block *blocks;
+	unsigned char *states;
+	size_t nblocks;
+	size_t sblocks;
+	struct hmemory_leak_range *roots;
+	size_t nroots;
+	size_t sroots;
+	size_t next;
+	struct hmemory_leak_range exclude[HMEMORY_LEAK_EXCLUDE_MAX];
+	unsigned int nexclude;
+	unsigned long long count[HMEMORY_LEAK_STATES];
+	unsigned long long bytes[HMEMORY_LEAK_STATES];
+	unsigned long long scanned;
+	unsigned int threads;
+};
+
+struct hmemory_leak_worker {
+	pthread_t thread;
+	struct hmemory_leak *leak;
+	size_t *stack;
+	size_t nstack;
+	size_t sstack;
+	void *mapping;
+};
+
+static void * debug_leak_map (size_t size)
+{
+	void *rc;
+	rc = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return (rc == MAP_FAILED) ? NULL : rc;
+}
+
+static int debug_leak_compare (const void *a, const void *b)
+{
+	const struct hmemory_leak_block *x = a;
+	const struct hmemory_leak_block *y = b;
+	return (x->start < y->start) ? -1 : (x->start > y->start) ? 1 : 0;
+}
+
+static inline ssize_t debug_leak_find (struct hmemory_leak *leak, uintptr_t address)
+{
+	size_t l;
+	size_t h;
+	size_t m;
+	if (leak->nblocks == 0 ||
+	    address < leak->blocks[0].start ||
+	    address >= leak->blocks[leak->nblocks - 1].end) {
+		return -1;
+	}
+	l = 0;
+	h = leak->nblocks;
+	while (h - l > 1) {
+		m = (l + h) / 2;
+		if (leak->blocks[m].start <= address) {
+			l = m;
+		} else {
+			h = m;
+		}
+	}
+	return (address >= leak->blocks[l].start && address < leak->blocks[l].end) ? (ssize_t) l : -1;
+}
+
+static int debug_leak_push (struct hmemory_leak_worker *w, size_t i)
+{
+	size_t s;
+	size_t *n;
+	if (w->nstack == w->sstack) {
+		s = (w->sstack == 0) ? 4096 : w->sstack * 2;
+		n = debug_leak_map(s * sizeof(size_t));
+		if (n == NULL) {
+			return -1;
+		}
+		if (w->stack != NULL) {
+			memcpy(n, w->stack, w->nstack * sizeof(size_t));
+			munmap(w->stack, w->sstack * sizeof(size_t));
+		}
+		w->stack = n;
+		w->sstack = s;
+	}
+	w->stack[w->nstack++] = i;
+	return 0;
+}
+
+static void debug_leak_scan (struct hmemory_leak_worker *w, uintptr_t start, uintptr_t end)
+{
+	ssize_t i;
+	unsigned char unknown;
+	struct hmemory_leak *leak;
+	leak = w->leak;
+	start = (start + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+	for (; start + sizeof(uintptr_t) <= end; start += sizeof(uintptr_t)) {
+		i = debug_leak_find(leak, *(uintptr_t *) start);
+		if (i < 0) {
+			continue;
+		}
+		unknown = HMEMORY_LEAK_UNKNOWN;
+		if (__atomic_compare_exchange_n(&leak->states[i], &unknown, HMEMORY_LEAK_REACHABLE, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			debug_leak_push(w, i);
+		}
+	}
+}
+
+static void * debug_leak_worker (void *arg)
+{
+	size_t r;
+	size_t i;
+	struct hmemory_leak *leak;
+	struct hmemory_leak_worker *w;
+	hpreload_guard(1);
+	w = arg;
+	leak = w->leak;
+	while ((r = __atomic_fetch_add(&leak->next, 1, __ATOMIC_RELAXED)) < leak->nroots) {
+		debug_leak_scan(w, leak->roots[r].start, leak->roots[r].end);
+	}
+	while (w->nstack > 0) {
+		i = w->stack[--w->nstack];
+		debug_leak_scan(w, leak->blocks[i].start, leak->blocks[i].end);
+	}
+	return NULL;
+}
+
+static int debug_leak_root (struct hmemory_leak *leak, uintptr_t start, uintptr_t end)
+{
+	size_t s;
+	struct hmemory_leak_range *n;
+	while (start < end) {
+		if (leak->nroots == leak->sroots) {
+			s = (leak->sroots == 0) ? 1024 : leak->sroots * 2;
+			n = debug_leak_map(s * sizeof(struct hmemory_leak_range));
+			if (n == NULL) {
+				return -1;
+			}
+			if (leak->roots != NULL) {
+				memcpy(n, leak->roots, leak->nroots * sizeof(struct hmemory_leak_range));
+				munmap(leak->roots, leak->sroots * sizeof(struct hmemory_leak_range));
+			}
+			leak->roots = n;
+			leak->sroots = s;
+		}
+		leak->roots[leak->nroots].start = start;
+		leak->roots[leak->nroots].end = (end - start > HMEMORY_LEAK_CHUNK) ? start + HMEMORY_LEAK_CHUNK : end;
+		leak->scanned += leak->roots[leak->nroots].end - start;
+		start = leak->roots[leak->nroots].end;
+		leak->nroots += 1;
+	}
+	return 0;
+}
+
+/*
+ * adds [start, end) to the roots, minus excluded ranges and the extents of
+ * tracked blocks, whose contents only count once they are reachable.
+ */
+static int debug_leak_roots (struct hmemory_leak *leak, uintptr_t start, uintptr_t end)
+{
+	size_t l;
+	size_t h;
+	size_t m;
+	unsigned int e;
+	for (e = 0; e < leak->nexclude; e++) {
+		if (start < leak->exclude[e].end && leak->exclude[e].start < end) {
+			if (start < leak->exclude[e].start && debug_leak_roots(leak, start, leak->exclude[e].start) != 0) {
+				return -1;
+			}
+			if (leak->exclude[e].end < end && debug_leak_roots(leak, leak->exclude[e].end, end) != 0) {
+				return -1;
+			}
+			return 0;
+		}
+	}
+	l = 0;
+	h = leak->nblocks;
+	while (l < h) {
+		m = (l + h) / 2;
+		if (leak->blocks[m].end + hmemory_signature_size <= start) {
+			l = m + 1;
+		} else {
+			h = m;
+		}
+	}
+	for (; l < leak->nblocks && leak->blocks[l].base < end; l++) {
+		if (start < leak->blocks[l].base && debug_leak_root(leak, start, leak->blocks[l].base) != 0) {
+			return -1;
+		}
+		start = leak->blocks[l].end + hmemory_signature_size;
+	}
+	return (start < end) ? debug_leak_root(leak, start, end) : 0;
+}
+
+static int debug_leak_maps (struct hmemory_leak *leak, uintptr_t sp)
+{
+	FILE *fp;
+	char line[512];
+	char perms[8];
+	char path[256];
+	unsigned long start;
+	unsigned long end;
+	fp = fopen("/proc/self/maps", "r");
+	if (fp == NULL) {
+		return -1;
+	}
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		path[0] = '\0';
+		if (sscanf(line, "%lx-%lx %7s %*s %*s %*s %255s", &start, &end, perms, path) < 3) {
+			continue;
+		}
+		if (perms[0] != 'r' || perms[1] != 'w') {
+			continue;
+		}
+		if (strncmp(path, "/dev/", 5) == 0 ||
+		    strcmp(path, "[vvar]") == 0 ||
+		    strcmp(path, "[vsyscall]") == 0) {
+			continue;
+		}
+		if (sp >= start && sp < end) {
+			start = sp;
+		}
+		if (debug_leak_roots(leak, start, end) != 0) {
+			fclose(fp);
+			return -1;
+		}
+	}
+	fclose(fp);
+	return 0;
+}
+
+static void debug_leak_classify (struct hmemory_leak *leak, struct hmemory_leak_worker *w)
+{
+	size_t i;
+	size_t j;
+	ssize_t c;
+	uintptr_t p;
+	for (i = 0; i < leak->nblocks; i++) {
+		if (leak->states[i] != HMEMORY_LEAK_UNKNOWN) {
+			continue;
+		}
+		leak->states[i] = HMEMORY_LEAK_DEFINITE;
+		debug_leak_push(w, i);
+		while (w->nstack > 0) {
+			j = w->stack[--w->nstack];
+			p = (leak->blocks[j].start + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+			for (; p + sizeof(uintptr_t) <= leak->blocks[j].end; p += sizeof(uintptr_t)) {
+				c = debug_leak_find(leak, *(uintptr_t *) p);
+				if (c < 0 || (size_t) c == i) {
+					continue;
+				}
+				if (leak->states[c] == HMEMORY_LEAK_UNKNOWN) {
+					leak->states[c] = HMEMORY_LEAK_INDIRECT;
+					debug_leak_push(w, c);
+				} else if (leak->states[c] == HMEMORY_LEAK_DEFINITE) {
+					leak->states[c] = HMEMORY_LEAK_INDIRECT;
+				}
+			}
+		}
+	}
+	for (i = 0; i < leak->nblocks; i++) {
+		leak->count[leak->states[i]] += 1;
+		leak->bytes[leak->states[i]] += leak->blocks[i].end - leak->blocks[i].start;
+	}
+}
+
+/*
+ * called with the tracker lock held, after the worker has stopped. the
+ * frame of this function and everything above it on the calling thread's
+ * stack are roots, including registers spilled by __builtin_unwind_init.
+ */
+static int __attribute__ ((noinline)) debug_leak_check (struct hmemory_leak *leak)
+{
+	int v;
+	int rc;
+	size_t i;
+	unsigned int t;
+	long cpus;
+	uintptr_t sp;
+	struct hmemory_memory *m;
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+	struct hmemory_memory *nm;
+#endif
+	struct hmemory_leak_worker workers[HMEMORY_LEAK_THREADS_MAX];
+	pthread_attr_t attr;
+	__builtin_unwind_init();
+	sp = ((uintptr_t) &sp) & ~(sizeof(uintptr_t) - 1);
+	memset(leak, 0, sizeof(struct hmemory_leak));
+	memset(workers, 0, sizeof(workers));
+	if (hconfig(leak_check) == 0) {
+		return -1;
+	}
+	v = hconfig(leak_threads);
+	cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	leak->threads = (v > 0) ? (unsigned int) v : (cpus > 0) ? (unsigned int) cpus : 1;
+	if (leak->threads > HMEMORY_LEAK_THREADS_MAX) {
+		leak->threads = HMEMORY_LEAK_THREADS_MAX;
+	}
+	leak->sblocks = debug_memory_count();
+	if (leak->sblocks == 0) {
+		return 0;
+	}
+	leak->blocks = debug_leak_map(leak->sblocks * sizeof(struct hmemory_leak_block));
+	leak->states = debug_leak_map(leak->sblocks);
+	if (leak->blocks == NULL || leak->states == NULL) {
+		goto bail;
+	}
+	leak->exclude[leak->nexclude].start = (uintptr_t) leak->blocks;
+	leak->exclude[leak->nexclude].end = (uintptr_t) leak->blocks + leak->sblocks * sizeof(struct hmemory_leak_block);
+	leak->nexclude += 1;
+	if (debug_scan.missing == 0) {
+		for (i = 0; i < debug_scan.count; i++) {
+			leak->blocks[i].base = (uintptr_t) debug_scan.memory[i]->base;
+			leak->blocks[i].start = debug_scan.address[i] + hmemory_signature_size;
+			leak->blocks[i].end = debug_scan.address[i] + debug_scan.size[i] - hmemory_signature_size;
+			leak->blocks[i].memory = debug_scan.memory[i];
+		}
+		leak->nblocks = debug_scan.count;
+	} else {
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+		HASH_ITER(hh, debug_memory, m, nm) {
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+		debug_table_foreach(&debug_memory, m,
+#endif
+			leak->blocks[leak->nblocks].base = (uintptr_t) m->base;
+			leak->blocks[leak->nblocks].start = (uintptr_t) m->address + hmemory_signature_size;
+			leak->blocks[leak->nblocks].end = (uintptr_t) m->address + m->size - hmemory_signature_size;
+			leak->blocks[leak->nblocks].memory = m;
+			leak->nblocks += 1;
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+		}
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+		)
+#endif
+		debug_table_foreach(&debug_large, m,
+			leak->blocks[leak->nblocks].base = (uintptr_t) m->base;
+			leak->blocks[leak->nblocks].start = (uintptr_t) m->address + hmemory_signature_size;
+			leak->blocks[leak->nblocks].end = (uintptr_t) m->address + m->size - hmemory_signature_size;
+			leak->blocks[leak->nblocks].memory = m;
+			leak->nblocks += 1;
+		)
+	}
+	qsort(leak->blocks, leak->nblocks, sizeof(struct hmemory_leak_block), debug_leak_compare);
+	for (t = 1; t < leak->threads; t++) {
+		workers[t].mapping = debug_leak_map(HMEMORY_LEAK_STACK);
+		if (workers[t].mapping == NULL) {
+			break;
+		}
+		leak->exclude[leak->nexclude].start = (uintptr_t) workers[t].mapping;
+		leak->exclude[leak->nexclude].end = (uintptr_t) workers[t].mapping + HMEMORY_LEAK_STACK;
+		leak->nexclude += 1;
+	}
+	leak->threads = t;
+	if (debug_leak_maps(leak, sp) != 0) {
+		goto bail;
+	}
+	for (t = 0; t < leak->threads; t++) {
+		workers[t].leak = leak;
+	}
+	for (t = 1; t < leak->threads; t++) {
+		pthread_attr_init(&attr);
+		pthread_attr_setstack(&attr, workers[t].mapping, HMEMORY_LEAK_STACK);
+		rc = pthread_create(&workers[t].thread, &attr, debug_leak_worker, &workers[t]);
+		pthread_attr_destroy(&attr);
+		if (rc != 0) {
+			workers[t].leak = NULL;
+		}
+	}
+	debug_leak_worker(&workers[0]);
+	hpreload_guard(1);
+	for (t = 1; t < leak->threads; t++) {
+		if (workers[t].leak != NULL) {
+			pthread_join(workers[t].thread, NULL);
+		}
+	}
+	debug_leak_classify(leak, &workers[0]);
+	rc = 0;
+	goto out;
+bail:
+	rc = -1;
+out:
+	for (t = 0; t < leak->threads; t++) {
+		if (workers[t].stack != NULL) {
+			munmap(workers[t].stack, workers[t].sstack * sizeof(size_t));
+		}
+		if (workers[t].mapping != NULL) {
+			munmap(workers[t].mapping, HMEMORY_LEAK_STACK);
+		}
+	}
+	if (leak->roots != NULL) {
+		munmap(leak->roots, leak->sroots * sizeof(struct hmemory_leak_range));
+		leak->roots = NULL;
+	}
+	return rc;
+}
+
+static void debug_leak_free (struct hmemory_leak *leak)
+{
+	if (leak->blocks != NULL) {
+		munmap(leak->blocks, leak->sblocks * sizeof(struct hmemory_leak_block));
+	}
+	if (leak->states != NULL) {
+		munmap(leak->states, leak->sblocks);
+	}
+	memset(leak, 0, sizeof(struct hmemory_leak));
+}
+
+static int debug_leak_write (int fd, const void *buffer, size_t size)
+{
+	ssize_t rc;
+	const char *b;
+	b = buffer;
+	while (size > 0) {
+		rc = write(fd, b, size);
+		if (rc < 0 && errno == EINTR) {
+			continue;
+		}
+		if (rc <= 0) {
+			return -1;
+		}
+		b += rc;
+		size -= rc;
+	}
+	return 0;
+}
+
+/*
+ * writes one report line to fd, or through hinfof when fd is negative.
+ */
+static int __attribute__ ((format(printf, 2, 3))) debug_leak_printf (int fd, const char *fmt, ...)
+{
+	int rc;
+	va_list ap;
+	char line[1024];
+	va_start(ap, fmt);
+	rc = vsnprintf(line, sizeof(line) - 1, fmt, ap);
+	va_end(ap);
+	if (rc < 0) {
+		return -1;
+	}
+	if (fd < 0) {
+		hinfof("%s", line);
+		return 0;
+	}
+	if ((size_t) rc > sizeof(line) - 2) {
+		rc = sizeof(line) - 2;
+	}
+	line[rc++] = '\n';
+	return debug_leak_write(fd, line, rc);
+}
+
+/*
+ * leaked blocks are reported per allocation site, sorted by bytes, instead
+ * of one line per block. sites are keyed by the func, file and line the
+ * records already carry, which are symbolic for both the macros and the
+ * preload interposers, so nothing is resolved at exit.
+ */
+#define HMEMORY_LEAK_SAMPLES			3
+
+struct hmemory_leak_site {
 	const char *func;
 	const char *file;
 	int line;
-	size_t size;
+	unsigned long long blocks;
+	unsigned long long bytes;
+	unsigned long long count[HMEMORY_LEAK_STATES];
+	void *samples[HMEMORY_LEAK_SAMPLES];
+};
+
+struct hmemory_leak_sites {
+	struct hmemory_leak_site *sites;
+	size_t nsites;
+	size_t ssites;
+};
+
+static inline size_t debug_leak_site_hash (const char *func, const char *file, int line)
+{
+	uintptr_t h;
+	h = (uintptr_t) func * 31 + (uintptr_t) file;
+	h = h * 31 + (unsigned int) line;
+	return (size_t) (h ^ (h >> 17)) * 2654435761U;
+}
+
+static int debug_leak_site_add (struct hmemory_leak_sites *sites, struct hmemory_memory *m, int state)
+{
+	size_t i;
+	size_t j;
+	size_t s;
+	struct hmemory_leak_site *n;
+	struct hmemory_leak_site *site;
+	if (sites->nsites * 2 >= sites->ssites) {
+		s = (sites->ssites == 0) ? 1024 : sites->ssites * 2;
+		n = calloc(s, sizeof(struct hmemory_leak_site));
+		if (n == NULL) {
+			return -1;
+		}
+		for (i = 0; i < sites->ssites; i++) {
+			site = &sites->sites[i];
+			if (site->blocks == 0) {
+				continue;
+			}
+			for (j = debug_leak_site_hash(site->func, site->file, site->line) & (s - 1); n[j].blocks != 0; j = (j + 1) & (s - 1)) {
+			}
+			n[j] = *site;
+		}
+		free(sites->sites);
+		sites->sites = n;
+		sites->ssites = s;
+	}
+	i = debug_leak_site_hash(m->func, m->file, m->line) & (sites->ssites - 1);
+	while (1) {
+		site = &sites->sites[i];
+		if (site->blocks == 0) {
+			site->func = m->func;
+			site->file = m->file;
+			site->line = m->line;
+			sites->nsites += 1;
+			break;
+		}
+		if (site->func == m->func && site->file == m->file && site->line == m->line) {
+			break;
+		}
+		i = (i + 1) & (sites->ssites - 1);
+	}
+	if (site->blocks < HMEMORY_LEAK_SAMPLES) {
+		site->samples[site->blocks] = m->address + hmemory_signature_size;
+	}
+	site->blocks += 1;
+	site->bytes += m->size - hmemory_signature_size * 2;
+	site->count[state] += 1;
+	return 0;
+}
+
+static int debug_leak_site_compare (const void *a, const void *b)
+{
+	const struct hmemory_leak_site *x = a;
+	const struct hmemory_leak_site *y = b;
+	if (x->bytes != y->bytes) {
+		return (x->bytes > y->bytes) ? -1 : 1;
+	}
+	return (x->blocks > y->blocks) ? -1 : (x->blocks < y->blocks) ? 1 : 0;
+}
+
+static int debug_leak_listed (int state, int show_reachable)
+{
+	return show_reachable == 1 || state == HMEMORY_LEAK_DEFINITE || state == HMEMORY_LEAK_INDIRECT;
+}
+
+/*
+ * prints the top hmemory_leak_top sites of the blocks that are lost, or of
+ * all blocks with show_reachable. uses the scan results when there are any,
+ * the tracking table otherwise. sites matching a leak suppression are left
+ * out, returns the number of blocks reported, -1 on failure.
+ */
+static long long debug_leak_sites (struct hmemory_leak *leak, int show_reachable, int fd)
+{
+	int v;
+	int state;
+	size_t i;
+	size_t top;
+	long long rc;
+	unsigned long long sblocks;
+	unsigned long long sbytes;
+	size_t ssites;
+	struct hmemory_suppression *suppression;
+	char samples[HMEMORY_LEAK_SAMPLES * 24];
+	unsigned long long blocks;
+	unsigned long long bytes;
+	struct hmemory_leak_site *site;
+	struct hmemory_leak_sites sites;
+	struct hmemory_memory *m;
 #if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-	UT_hash_handle hh;
+	struct hmemory_memory *nm;
+#endif
+	rc = -1;
+	memset(&sites, 0, sizeof(sites));
+	if (leak->states != NULL) {
+		for (i = 0; i < leak->nblocks; i++) {
+			state = leak->states[i];
+			if (debug_leak_listed(state, show_reachable) && debug_leak_site_add(&sites, leak->blocks[i].memory, state) != 0) {
+				goto bail;
+			}
+		}
+	} else if (show_reachable == 1) {
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+		HASH_ITER(hh, debug_memory, m, nm) {
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+		debug_table_foreach(&debug_memory, m,
+#endif
+			if (debug_leak_site_add(&sites, m, HMEMORY_LEAK_UNKNOWN) != 0) {
+				goto bail;
+			}
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+		}
 #elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+		)
+#endif
+		debug_table_foreach(&debug_large, m,
+			if (debug_leak_site_add(&sites, m, HMEMORY_LEAK_UNKNOWN) != 0) {
+				goto bail;
+			}
+		)
+	}
+	sblocks = 0;
+	sbytes = 0;
+	ssites = 0;
+	for (i = 0, top = 0; i < sites.ssites; i++) {
+		site = &sites.sites[i];
+		if (site->blocks == 0) {
+			continue;
+		}
+		suppression = debug_suppress_find(HMEMORY_SUPPRESS_LEAK, site->func, site->file, site->line);
+		if (suppression != NULL) {
+			suppression->hits += site->blocks;
+			suppression->bytes += site->bytes;
+			sblocks += site->blocks;
+			sbytes += site->bytes;
+			ssites += 1;
+			continue;
+		}
+		sites.sites[top++] = *site;
+	}
+	sites.nsites = top;
+	rc = 0;
+	if (sites.nsites == 0) {
+		goto suppressed;
+	}
+	qsort(sites.sites, sites.nsites, sizeof(struct hmemory_leak_site), debug_leak_site_compare);
+	v = hconfig(leak_top);
+	top = (v <= 0 || (size_t) v > sites.nsites) ? sites.nsites : (size_t) v;
+	debug_leak_printf(fd, "  memory leaks: %zu sites", sites.nsites);
+	for (i = 0; i < top; i++) {
+		site = &sites.sites[i];
+		samples[0] = '\0';
+		for (v = 0; v < HMEMORY_LEAK_SAMPLES && (unsigned long long) v < site->blocks; v++) {
+			snprintf(samples + strlen(samples), sizeof(samples) - strlen(samples), " %p", site->samples[v]);
+		}
+		debug_leak_printf(fd, "    - %llu bytes in %llu blocks at: %s (%s:%u)", site->bytes, site->blocks, site->func, site->file, site->line);
+		if (site->count[HMEMORY_LEAK_UNKNOWN] != site->blocks) {
+			debug_leak_printf(fd, "        definitely lost: %llu, indirectly lost: %llu, still reachable: %llu blocks",
+				site->count[HMEMORY_LEAK_DEFINITE], site->count[HMEMORY_LEAK_INDIRECT], site->count[HMEMORY_LEAK_REACHABLE]);
+		}
+		debug_leak_printf(fd, "        at:%s%s", samples, (site->blocks > HMEMORY_LEAK_SAMPLES) ? " ..." : "");
+	}
+	if (top < sites.nsites) {
+		for (blocks = 0, bytes = 0; i < sites.nsites; i++) {
+			blocks += sites.sites[i].blocks;
+			bytes += sites.sites[i].bytes;
+		}
+		debug_leak_printf(fd, "    - %llu bytes in %llu blocks at %zu more sites", bytes, blocks, sites.nsites - top);
+	}
+	for (i = 0; i < sites.nsites; i++) {
+		rc += sites.sites[i].blocks;
+	}
+suppressed:
+	if (ssites > 0) {
+		debug_leak_printf(fd, "  suppressed leaks: %llu bytes in %llu blocks at %zu sites", sbytes, sblocks, ssites);
+	}
+bail:
+	free(sites.sites);
+	return rc;
+}
+
+/*
+ * live leak check for processes that never exit. the tracker lock is held
+ * only across fork, the child scans the copy on write image of the process,
+ * with every block the parent had at that moment, and streams a summary
+ * and the lost blocks back over a pipe. registers of the other threads are
+ * not seen, only their stacks.
+ */
+struct hmemory_leak_result {
+	int rc;
+	unsigned int threads;
+	unsigned long long ns;
+	unsigned long long scanned;
+	unsigned long long count[HMEMORY_LEAK_STATES];
+	unsigned long long bytes[HMEMORY_LEAK_STATES];
+};
+
+static volatile sig_atomic_t hmemory_leak_requested;
+static __thread int hmemory_leak_forking;
+
+static void debug_leak_signal (int signum)
+{
+	(void) signum;
+	hmemory_leak_requested = 1;
+}
+
+static void __attribute__ ((noreturn)) debug_leak_child (int fd)
+{
+	int show_reachable;
+	unsigned long long ns;
+	struct hmemory_leak leak;
+	struct hmemory_leak_result result;
+	ns = debug_getclock_ns();
+	memset(&result, 0, sizeof(result));
+	result.rc = debug_leak_check(&leak);
+	result.ns = debug_getclock_ns() - ns;
+	result.threads = leak.threads;
+	result.scanned = leak.scanned;
+	memcpy(result.count, leak.count, sizeof(result.count));
+	memcpy(result.bytes, leak.bytes, sizeof(result.bytes));
+	if (debug_leak_write(fd, &result, sizeof(result)) != 0 || result.rc != 0) {
+		_exit(1);
+	}
+	show_reachable = hconfig(show_reachable);
+	debug_leak_sites(&leak, show_reachable, fd);
+	_exit(0);
+}
+
+static int debug_leak_fork (struct hmemory_leak_result *result)
+{
+	int rc;
+	int status;
+	pid_t pid;
+	int fds[2];
+	char *e;
+	char *s;
+	ssize_t r;
+	size_t size;
+	int state;
+	char buffer[4096];
+	status = 0;
+	memset(result, 0, sizeof(struct hmemory_leak_result));
+	if (pipe(fds) != 0) {
+		herrorf("pipe failed");
+		return -1;
+	}
+	hmemory_leak_forking = 1;
+	pid = fork();
+	if (pid == 0) {
+		close(fds[0]);
+		debug_leak_child(fds[1]);
+	}
+	hmemory_leak_forking = 0;
+	close(fds[1]);
+	if (pid < 0) {
+		herrorf("fork failed");
+		close(fds[0]);
+		return -1;
+	}
+	rc = -1;
+	size = 0;
+	while (size < sizeof(struct hmemory_leak_result)) {
+		r = read(fds[0], ((char *) result) + size, sizeof(struct hmemory_leak_result) - size);
+		if (r < 0 && errno == EINTR) {
+			continue;
+		}
+		if (r <= 0) {
+			break;
+		}
+		size += r;
+	}
+	if (size == sizeof(struct hmemory_leak_result) && result->rc == 0) {
+		rc = 0;
+		hdebug_lock();
+		hinfof("leak check:");
+		for (state = HMEMORY_LEAK_DEFINITE; state > HMEMORY_LEAK_UNKNOWN; state--) {
+			hinfof("  %-16s: %llu bytes in %llu blocks", hmemory_leak_states[state], result->bytes[state], result->count[state]);
+		}
+		hinfof("  scanned %llu bytes of roots with %u threads in %llu.%03llu ms", result->scanned, result->threads, result->ns / 1000000, (result->ns / 1000) % 1000);
+		size = 0;
+		while (1) {
+			r = read(fds[0], buffer + size, sizeof(buffer) - 1 - size);
+			if (r < 0 && errno == EINTR) {
+				continue;
+			}
+			if (r <= 0) {
+				break;
+			}
+			size += r;
+			buffer[size] = '\0';
+			for (s = buffer; (e = strchr(s, '\n')) != NULL; s = e + 1) {
+				*e = '\0';
+				hinfof("%s", s);
+			}
+			size -= s - buffer;
+			memmove(buffer, s, size);
+			if (size == sizeof(buffer) - 1) {
+				size = 0;
+			}
+		}
+		hdebug_unlock();
+	}
+	close(fds[0]);
+	while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+	}
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+		rc = -1;
+	}
+	return rc;
+}
+
+static int debug_leak_due (unsigned long long *last)
+{
+	int v;
+	unsigned long long now;
+	now = debug_getclock_ns();
+	if (hmemory_leak_requested) {
+		hmemory_leak_requested = 0;
+		*last = now;
+		return 1;
+	}
+	v = hconfig(leak_interval);
+	if (v <= 0 || now - *last < ((unsigned long long) v) * 1000000ULL) {
+		return 0;
+	}
+	*last = now;
+	return 1;
+}
+
+static void * hmemory_worker (void *arg)
+{
+	int check;
+	int export;
+	unsigned int v;
+	unsigned long long leak;
+	struct hmemory_leak_result result;
+	struct hmemory_histogram_snapshot snapshot;
+	struct timeval tval;
+	struct timespec tspec;
+	(void) arg;
+	hpreload_guard(1);
+	leak = debug_getclock_ns();
+	while (1) {
+		check = 1;
+		v = hconfig(check_interval);
+		if (v == (unsigned int) -1) {
+			check = 0;
+			v = HMEMORY_CHECK_INTERVAL;
+		}
+		gettimeofday(&tval, NULL);
+		tspec.tv_sec = tval.tv_sec + (v / 1000);
+		tspec.tv_nsec = (tval.tv_usec + ((v % 1000) * 1000)) * 1000;
+		if (tspec.tv_nsec >= 1000000000) {
+			tspec.tv_sec += 1;
+			tspec.tv_nsec -= 1000000000;
+		}
+		hmemory_lock();
+		if (hmemory_worker_running == 1) {
+			pthread_cond_timedwait(&hmemory_cond, &hmemory_mutex, &tspec);
+		}
+		if (hmemory_worker_running == 0) {
+			hmemory_unlock();
+			break;
+		}
+		debug_config_reload();
+		if (debug_leak_due(&leak)) {
+			hmemory_unlock();
+			debug_leak_fork(&result);
+			hmemory_lock();
+		}
+		if (check == 0) {
+			hmemory_unlock();
+			continue;
+		}
+		debug_scan_check("worker check", __FUNCTION__, __FILE__, __LINE__);
+		debug_statistics_report();
+		debug_histogram_report();
+		debug_copy_report();
+		debug_profile_report();
+		export = debug_histogram_snapshot(&snapshot);
+		hmemory_unlock();
+		if (export) {
+			debug_histogram_export(&snapshot);
+		}
+	}
+	return NULL;
+}
+
+/*
+ * fork handlers. the forking thread takes every tracker lock before fork, so
+ * the child gets the tracking table in a consistent state, and the child
+ * resets them since their owner is a thread id of the parent. the worker
+ * does not survive fork and is restarted in the child, except for the live
+ * leak check child, which only scans and exits. the table itself is not
+ * touched, metadata pages stay shared with the parent until either side
+ * writes to them.
+ */
+static void debug_fork_prepare (void)
+{
+	hmemory_lock();
+	hdebug_lock();
+	pthread_mutex_lock(&hmemory_suppress_mutex);
+	pthread_mutex_lock(&hmemory_statistics_mutex);
+	pthread_rwlock_wrlock(&debug_span_lock);
+}
+
+static void debug_fork_parent (void)
+{
+	pthread_rwlock_unlock(&debug_span_lock);
+	pthread_mutex_unlock(&hmemory_statistics_mutex);
+	pthread_mutex_unlock(&hmemory_suppress_mutex);
+	hdebug_unlock();
+	hmemory_unlock();
+}
+
+static void debug_fork_child (void)
+{
+	int rc;
+	hmemory_mutex = (pthread_mutex_t) HMEMORY_MUTEX_INITIALIZER;
+	hmemory_cond = (pthread_cond_t) PTHREAD_COND_INITIALIZER;
+	debugf_mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+	hmemory_suppress_mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+	hmemory_statistics_mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+	debug_span_lock_init();
+	if (hmemory_leak_forking == 1) {
+		return;
+	}
+	hpreload_guard(1);
+	if (hconfig(fork_statistics) == 0) {
+		debug_statistics_fork();
+	}
+	if (hmemory_worker_started == 1 && hmemory_finished == 0) {
+		hmemory_worker_running = 1;
+		rc = pthread_create(&hmemory_thread, NULL, hmemory_worker, NULL);
+		if (rc != 0) {
+			herrorf("failed to create worker");
+			hmemory_worker_started = 0;
+			hmemory_worker_running = 0;
+		}
+	}
+	hpreload_guard(0);
+}
+
+static void debug_init (void)
+{
+	int rc;
+	int signum;
+	struct sigaction action;
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+	debug_preload_init();
+#endif
+	hpreload_guard(1);
+	debug_config_load();
+	debug_metadata_init();
+	hmemory_lock();
+#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	debug_table_init_memory(&debug_memory, (hconfig(table_capacity) > 0) ? hconfig(table_capacity) : 0);
+#endif
+	debug_table_init_large(&debug_large, 0);
+	debug_table_init_span(&debug_span_pages, 0);
+	debug_table_init_span(&debug_span_regions, 0);
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+	debug_table_init_passed(&debug_passed, 0);
+#endif
+	debug_span_lock_init();
+#if (HMEMORY_ARENA_RECORDS > 0)
+	hmemory_arena_secret = (uintptr_t) (debug_getclock_ns() * 0x9e3779b97f4a7c15ULL) ^ (uintptr_t) &hmemory_arena_secret ^ (uintptr_t) getpid();
+#endif
+	debug_suppress_init();
+	if (hconfig(config_file)[0] != '\0') {
+		memset(&action, 0, sizeof(action));
+		action.sa_handler = debug_config_signal;
+		action.sa_flags = SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		if (sigaction(SIGHUP, &action, NULL) != 0) {
+			herrorf("can not install config reload handler");
+		}
+	}
+	signum = hconfig(leak_signal);
+	if (signum > 0) {
+		memset(&action, 0, sizeof(action));
+		action.sa_handler = debug_leak_signal;
+		action.sa_flags = SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		if (sigaction(signum, &action, NULL) != 0) {
+			herrorf("can not install leak check handler for signal %d", signum);
+		}
+	}
+	if (pthread_atfork(debug_fork_prepare, debug_fork_parent, debug_fork_child) != 0) {
+		herrorf("can not install fork handlers");
+	}
+	hmemory_worker_started = 1;
+	hmemory_worker_running = 1;
+	rc = pthread_create(&hmemory_thread, NULL, hmemory_worker, NULL);
+	if (rc != 0) {
+		herrorf("failed to create worker");
+		hmemory_worker_started = 0;
+		hmemory_worker_running = 0;
+	}
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+	__atomic_store_n(&hmemory_preload_active, 1, __ATOMIC_RELEASE);
 #endif
-	char name[0];
-};
-
-static pthread_t hmemory_thread;
-static int hmemory_worker_started		= 0;
-static int hmemory_worker_running		= 0;
+	hmemory_unlock();
+	hpreload_guard(0);
+}
 
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-static struct hmemory_memory *debug_memory	= NULL;
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-static khash_t(memory) *debug_memory		= NULL;
-#endif
-static unsigned long long memory_peak		= 0;
-static unsigned long long memory_current	= 0;
-static unsigned long long memory_total		= 0;
+static void __attribute__ ((constructor)) hmemory_init (void)
+{
+	pthread_once(&hmemory_once, debug_init);
+}
 
-static int debug_memory_add (const char *name, void *address, size_t size, const char *command, const char *func, const char *file, const int line)
+static void __attribute__ ((destructor)) hmemory_fini (void)
 {
-	unsigned int s;
+	int state;
+	int export;
+	int show_reachable;
+	long long listed;
+	unsigned long long ns;
+	struct hmemory_leak leak;
+	struct hmemory_histogram_snapshot snapshot;
+#if !defined(HMEMORY_PRELOAD) || (HMEMORY_PRELOAD == 0)
 	struct hmemory_memory *m;
-#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	int rc;
-	khiter_t k;
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+	struct hmemory_memory *nm;
 #endif
-	if (address == NULL) {
-		return 0;
+#endif
+	hpreload_guard(1);
+	hmemory_lock();
+	__atomic_store_n(&hmemory_finished, 1, __ATOMIC_RELEASE);
+	if (hmemory_worker_running == 1) {
+		hmemory_worker_running = 0;
+	}
+	pthread_cond_signal(&hmemory_cond);
+	hmemory_unlock();
+	if (hmemory_worker_started == 1) {
+		pthread_join(hmemory_thread, NULL);
 	}
 	hmemory_lock();
+	hdebug_lock();
+	ns = debug_getclock_ns();
+	if (debug_leak_check(&leak) != 0) {
+		debug_leak_free(&leak);
+	}
+	ns = debug_getclock_ns() - ns;
+	debug_statistics_report();
+	hinfof("    leaks  : %zu items", debug_memory_count());
+	if (leak.states != NULL) {
+		for (state = HMEMORY_LEAK_DEFINITE; state > HMEMORY_LEAK_UNKNOWN; state--) {
+			hinfof("      %-16s: %llu bytes in %llu blocks", hmemory_leak_states[state], leak.bytes[state], leak.count[state]);
+		}
+		hinfof("      scanned %llu bytes of roots with %u threads in %llu.%03llu ms", leak.scanned, leak.threads, ns / 1000000, (ns / 1000) % 1000);
+	}
+	debug_histogram_report();
+	debug_copy_report();
+	debug_profile_report();
+	export = debug_histogram_snapshot(&snapshot);
+	show_reachable = hconfig(show_reachable);
+	if (debug_memory_count() > 0 && (show_reachable == 1 || leak.count[HMEMORY_LEAK_DEFINITE] + leak.count[HMEMORY_LEAK_INDIRECT] > 0)) {
+		listed = debug_leak_sites(&leak, show_reachable, -1);
+		/* when preloaded, blocks may still be in use by later destructors */
+#if !defined(HMEMORY_PRELOAD) || (HMEMORY_PRELOAD == 0)
+		if (show_reachable == 1 && hconfig(fast_exit) != 1) {
 #if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-	HASH_FIND_PTR(debug_memory, &address, m);
+			HASH_ITER(hh, debug_memory, m, nm) {
+				HASH_DEL(debug_memory, m);
 #elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	k = kh_get(memory, debug_memory, address);
-	if (k == kh_end(debug_memory)) {
-		m = NULL;
-	} else {
-		m = kh_val(debug_memory, k);
+			debug_table_foreach(&debug_memory, m,
+#endif
+				free(m->base);
+				debug_memory_free(m);
+#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
+			}
+#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+			)
+#endif
+			debug_table_foreach(&debug_large, m,
+				debug_large_unmap(m->base, m->size, m->large);
+				debug_memory_free(m);
+			)
+		}
+#endif
+		if (show_reachable == 1 && listed != 0) {
+			hassert(0 && "memory leak");
+		}
+	}
+	if (debug_arena_report() != 0 && show_reachable == 1) {
+		hassert(0 && "memory leak");
 	}
+	debug_suppress_report();
+	debug_leak_free(&leak);
+#if !defined(HMEMORY_PRELOAD) || (HMEMORY_PRELOAD == 0)
+#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
+	debug_table_destroy_memory(&debug_memory);
 #endif
-	if (m != NULL) {
-		hdebug_lock();
-		hinfof("%s with invalid memory (%p)", command, address);
-		hinfof("    at: %s (%s:%d)", func, file, line);
-		hinfof("  ");
-		hinfof("  if it is certain that program is memory bug free, then hmemory");
-		hinfof("  may have a serious bug that needs to be fixed urgent. please ");
-		hinfof("  inform author");
-		hinfof("    at: alper.akcan@gmail.com");
-		hdebug_unlock();
-		hassert((m == NULL) && "invalid memory");
-		hmemory_unlock();
+	debug_table_destroy_large(&debug_large);
+	pthread_rwlock_wrlock(&debug_span_lock);
+	__atomic_store_n(&debug_span_low, UINTPTR_MAX, __ATOMIC_RELAXED);
+	__atomic_store_n(&debug_span_high, 0, __ATOMIC_RELAXED);
+	debug_table_destroy_span(&debug_span_pages);
+	debug_table_destroy_span(&debug_span_regions);
+	pthread_rwlock_unlock(&debug_span_lock);
+	debug_suppress_fini();
+	debug_config_fini();
+#endif
+	hdebug_unlock();
+	hmemory_unlock();
+	if (export) {
+		debug_histogram_export(&snapshot);
+	}
+	hpreload_guard(0);
+}
+
+#endif
+
+int HMEMORY_FUNCTION_NAME(information_actual) (const char *func, const char *file, const int line, struct hmemory_information *information)
+{
+	(void) func;
+	(void) file;
+	(void) line;
+	if (information == NULL) {
 		return -1;
 	}
-	s = sizeof(struct hmemory_memory) + strlen(name) + 1;
-	m = malloc(s);
-	memset(m, 0, s);
-	memcpy(m->name, name, strlen(name) + 1);
-	m->address = address;
-	m->size = size;
-	m->func = func;
-	m->file = file;
-	m->line = line;
-	memcpy(m->address, &hmemory_signature, hmemory_signature_size);
-	memcpy(m->address + m->size - hmemory_signature_size, &hmemory_signature, hmemory_signature_size);
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-	HASH_ADD_PTR(debug_memory, address, m);
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	k = kh_put(memory, debug_memory, address, &rc);
-	if (rc == -1) {
-		hdebug_lock();
-		hinfof("%s with invalid memory (%p)", command, address);
-		hinfof("    at: %s (%s:%d)", func, file, line);
-		hinfof("  ");
-		hinfof("  if it is certain that program is memory bug free, then hmemory");
-		hinfof("  may have a serious bug that needs to be fixed urgent. please ");
-		hinfof("  inform author");
-		hinfof("    at: alper.akcan@gmail.com");
-		hdebug_unlock();
-		hassert((rc == -1) && "invalid memory key");
+	memset(information, 0, sizeof(struct hmemory_information));
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	debug_statistics_get(&information->current, &information->peak, &information->total);
+	hmemory_lock();
+	information->blocks = debug_memory_count();
+#if (HMEMORY_ARENA_RECORDS > 0)
+	information->untracked = __atomic_load_n(&hmemory_arena_untracked, __ATOMIC_RELAXED);
+#endif
+	hmemory_unlock();
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+int HMEMORY_FUNCTION_NAME(leaks_actual) (const char *func, const char *file, const int line, struct hmemory_leaks *leaks)
+{
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	int rc;
+	struct hmemory_leak_result result;
+#endif
+	(void) func;
+	(void) file;
+	(void) line;
+	if (leaks == NULL) {
+		return -1;
+	}
+	memset(leaks, 0, sizeof(struct hmemory_leaks));
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	hpreload_guard(1);
+	rc = debug_leak_fork(&result);
+	hpreload_guard(0);
+	if (rc != 0) {
+		return -1;
+	}
+	leaks->definite_bytes = result.bytes[HMEMORY_LEAK_DEFINITE];
+	leaks->definite_blocks = result.count[HMEMORY_LEAK_DEFINITE];
+	leaks->indirect_bytes = result.bytes[HMEMORY_LEAK_INDIRECT];
+	leaks->indirect_blocks = result.count[HMEMORY_LEAK_INDIRECT];
+	leaks->reachable_bytes = result.bytes[HMEMORY_LEAK_REACHABLE];
+	leaks->reachable_blocks = result.count[HMEMORY_LEAK_REACHABLE];
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+
+/*
+ * call sites of allocations that arrive without a source location, from the
+ * c++ operators or the preload interposers, are identified by return address
+ * and resolved with dladdr once per thread through a small direct mapped
+ * cache. they are reported as symbol (object:offset).
+ */
+#define HMEMORY_CALLER_CACHE			256
+
+struct hmemory_caller {
+	void *caller;
+	const char *func;
+	const char *file;
+	int line;
+	int ignore;
+};
+
+static __thread struct hmemory_caller hmemory_callers[HMEMORY_CALLER_CACHE];
+
+static struct hmemory_caller * debug_caller_site (void *caller)
+{
+	Dl_info info;
+	struct hmemory_caller *s;
+	s = &hmemory_callers[(((uintptr_t) caller) * 2654435761U >> 8) & (HMEMORY_CALLER_CACHE - 1)];
+	if (__builtin_expect(s->caller == caller, 1)) {
+		return s;
+	}
+	s->caller = caller;
+	s->func = "(unknown)";
+	s->file = "(unknown)";
+	s->line = (int) (uintptr_t) caller;
+	s->ignore = 0;
+	if (dladdr(caller, &info) != 0) {
+		if (info.dli_sname != NULL) {
+			s->func = info.dli_sname;
+		}
+		if (info.dli_fname != NULL && *info.dli_fname != '\0') {
+			s->file = info.dli_fname;
+		}
+		s->line = (int) ((uintptr_t) caller - (uintptr_t) info.dli_fbase);
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+		s->ignore = (info.dli_fbase == hmemory_preload_loader);
+#endif
+	}
+	return s;
+}
+
+#endif
+
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+
+/*
+ * interposition for LD_PRELOAD=libhmemory-preload.so, which is this file
+ * built with HMEMORY_PRELOAD=1, no recompilation is needed. the next
+ * allocator is resolved with dlsym(RTLD_NEXT), and until it is, requests
+ * (dlsym itself calls calloc) are served from a static bump arena which is
+ * never reused. call sites are identified by return address. requests of
+ * nested calls, made before tracking started or by the dynamic loader itself
+ * (tls, link maps) are passed to the next allocator, the latter two are
+ * remembered so that their release is not taken for an invalid one.
+ */
+
+#define HMEMORY_PRELOAD_ARENA_SIZE		(64 * 1024)
+
+struct hmemory_preload_real {
+	void * (*malloc) (size_t size);
+	void * (*calloc) (size_t nmemb, size_t size);
+	void * (*realloc) (void *address, size_t size);
+	void (*free) (void *address);
+	void * (*memalign) (size_t alignment, size_t size);
+	int (*posix_memalign) (void **memptr, size_t alignment, size_t size);
+	size_t (*malloc_usable_size) (void *address);
+};
+
+static struct hmemory_preload_real hmemory_preload_real;
+static int hmemory_preload_state;
+static char hmemory_preload_arena[HMEMORY_PRELOAD_ARENA_SIZE] __attribute__ ((aligned(16)));
+static size_t hmemory_preload_arena_used;
+
+static void * debug_preload_arena_alloc (size_t alignment, size_t size)
+{
+	size_t used;
+	size_t start;
+	if (alignment < 16) {
+		alignment = 16;
+	}
+	used = __atomic_load_n(&hmemory_preload_arena_used, __ATOMIC_RELAXED);
+	do {
+		start = (used + sizeof(size_t) + alignment - 1) & ~(alignment - 1);
+		if (start + size < start || start + size > HMEMORY_PRELOAD_ARENA_SIZE) {
+			errno = ENOMEM;
+			return NULL;
+		}
+	} while (!__atomic_compare_exchange_n(&hmemory_preload_arena_used, &used, start + size, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	*(size_t *) (hmemory_preload_arena + start - sizeof(size_t)) = size;
+	return hmemory_preload_arena + start;
+}
+
+static inline int debug_preload_arena_contains (void *address)
+{
+	return ((char *) address >= hmemory_preload_arena) && ((char *) address < hmemory_preload_arena + HMEMORY_PRELOAD_ARENA_SIZE);
+}
+
+static inline size_t debug_preload_arena_size (void *address)
+{
+	return *(size_t *) ((char *) address - sizeof(size_t));
+}
+
+/*
+ * releases a block hmemory has already dropped, straight to the next
+ * allocator instead of through the interposed free and another lookup.
+ */
+static void debug_preload_free (void *address)
+{
+	if (address == NULL || debug_preload_arena_contains(address)) {
+		return;
+	}
+	hmemory_preload_real.free(address);
+}
+
+#define debug_preload_resolve(name) { \
+	*(void **) &hmemory_preload_real.name = dlsym(RTLD_NEXT, # name); \
+	if (hmemory_preload_real.name == NULL) { \
+		hassertf("can not resolve %s", # name); \
+	} \
+}
+
+static void debug_preload_init (void)
+{
+	int state;
+	Dl_info info;
+	state = 0;
+	if (!__atomic_compare_exchange_n(&hmemory_preload_state, &state, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		return;
+	}
+	debug_preload_resolve(malloc);
+	debug_preload_resolve(calloc);
+	debug_preload_resolve(realloc);
+	debug_preload_resolve(free);
+	debug_preload_resolve(memalign);
+	debug_preload_resolve(posix_memalign);
+	debug_preload_resolve(malloc_usable_size);
+	if (dladdr(&_r_debug, &info) != 0) {
+		hmemory_preload_loader = info.dli_fbase;
+	}
+	__atomic_store_n(&hmemory_preload_state, 2, __ATOMIC_RELEASE);
+}
+
+static inline int debug_preload_ready (void)
+{
+	if (__builtin_expect(__atomic_load_n(&hmemory_preload_state, __ATOMIC_ACQUIRE) == 2, 1)) {
+		return 1;
+	}
+	debug_preload_init();
+	return __atomic_load_n(&hmemory_preload_state, __ATOMIC_ACQUIRE) == 2;
+}
+
+static inline int debug_preload_enter (void)
+{
+	if (hmemory_preload_guard != 0) {
+		return 0;
+	}
+	if (__atomic_load_n(&hmemory_preload_active, __ATOMIC_ACQUIRE) == 0) {
+		return 0;
+	}
+	hmemory_preload_guard = 1;
+	return 1;
+}
+
+static inline void debug_preload_leave (void)
+{
+	hmemory_preload_guard = 0;
+}
+
+/*
+ * a block released from a nested call is tracked only if it is known and
+ * hmemory is not the one holding the lock.
+ */
+static inline int debug_preload_nested (void *address)
+{
+	if (address == NULL || hmemory_preload_guard == 0) {
+		return 0;
+	}
+	if (__atomic_load_n(&hmemory_preload_active, __ATOMIC_ACQUIRE) == 0) {
+		return 0;
+	}
+	return debug_memory_find(address - hmemory_signature_size, NULL, NULL, NULL) == 0;
+}
+
+static void * debug_preload_malloc (void *caller, size_t size)
+{
+	void *rc;
+	struct hmemory_caller *s;
+	if (debug_preload_enter() == 0) {
+		if (debug_preload_ready() == 0) {
+			return debug_preload_arena_alloc(16, size);
+		}
+		rc = hmemory_preload_real.malloc(size);
+		if (hmemory_preload_guard == 0) {
+			debug_preload_pass(rc);
+		}
+		return rc;
+	}
+	s = debug_caller_site(caller);
+	if (s->ignore) {
+		rc = hmemory_preload_real.malloc(size);
+		debug_preload_pass(rc);
+		debug_preload_leave();
+		return rc;
+	}
+	rc = HMEMORY_FUNCTION_NAME(malloc_actual)(s->func, s->file, s->line, "malloc", size);
+	debug_preload_leave();
+	if (rc == NULL) {
+		errno = ENOMEM;
+	}
+	return rc;
+}
+
+static void * debug_preload_calloc (void *caller, size_t nmemb, size_t size)
+{
+	void *rc;
+	size_t total;
+	struct hmemory_caller *s;
+	if (__builtin_mul_overflow(nmemb, size, &total)) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	if (debug_preload_enter() == 0) {
+		if (debug_preload_ready() == 0) {
+			return debug_preload_arena_alloc(16, total);
+		}
+		rc = hmemory_preload_real.calloc(nmemb, size);
+		if (hmemory_preload_guard == 0) {
+			debug_preload_pass(rc);
+		}
+		return rc;
+	}
+	s = debug_caller_site(caller);
+	if (s->ignore) {
+		rc = hmemory_preload_real.calloc(nmemb, size);
+		debug_preload_pass(rc);
+		debug_preload_leave();
+		return rc;
+	}
+	rc = HMEMORY_FUNCTION_NAME(calloc_actual)(s->func, s->file, s->line, "calloc", nmemb, size);
+	debug_preload_leave();
+	if (rc == NULL) {
+		errno = ENOMEM;
+	}
+	return rc;
+}
+
+/*
+ * the next allocator resizes blocks that were handed out untracked, they
+ * stay remembered under their new address.
+ */
+static void * debug_preload_repass (void *address, size_t size)
+{
+	void *rc;
+	rc = hmemory_preload_real.realloc(address, size);
+	debug_preload_pass((rc != NULL || size == 0) ? rc : address);
+	return rc;
+}
+
+static void * debug_preload_realloc (void *caller, void *address, size_t size)
+{
+	int passed;
+	int entered;
+	void *rc;
+	struct hmemory_caller *s;
+	if (address != NULL && debug_preload_arena_contains(address)) {
+		rc = debug_preload_malloc(caller, size);
+		if (rc != NULL) {
+			memcpy(rc, address, (debug_preload_arena_size(address) < size) ? debug_preload_arena_size(address) : size);
+		}
+		return rc;
+	}
+	entered = debug_preload_enter();
+	if (entered == 0) {
+		if (debug_preload_ready() == 0) {
+			return debug_preload_arena_alloc(16, size);
+		}
+		if (hmemory_preload_guard == 0) {
+			debug_preload_early_forget(address);
+			return debug_preload_repass(address, size);
+		}
+		if (!debug_preload_nested(address)) {
+			return hmemory_preload_real.realloc(address, size);
+		}
+	}
+	s = debug_caller_site(caller);
+	if (entered == 1 && address == NULL && s->ignore) {
+		rc = debug_preload_repass(NULL, size);
+		debug_preload_leave();
+		return rc;
+	}
+	if (entered == 1 && address != NULL && debug_memory_find(address - hmemory_signature_size, NULL, NULL, NULL) != 0) {
+		hmemory_lock();
+		passed = debug_preload_passed(address);
 		hmemory_unlock();
-		return -1;
+		if (passed) {
+			rc = debug_preload_repass(address, size);
+			debug_preload_leave();
+			return rc;
+		}
 	}
-	kh_value(debug_memory, k) = m;
-#endif
-	hdebugf("%s added memory: %s, address: %p, size: %zd, func: %s, file: %s, line: %d", command, m->name, m->address, m->size, m->func, m->file, m->line);
-	memory_total += (size - (hmemory_signature_size * 2));
-	memory_current += (size - (hmemory_signature_size * 2));
-	memory_peak = MAX(memory_peak, memory_current);
-	hmemory_unlock();
-	return 0;
+	rc = HMEMORY_FUNCTION_NAME(realloc_actual)(s->func, s->file, s->line, "realloc", address, size);
+	if (entered == 1) {
+		debug_preload_leave();
+	}
+	if (rc == NULL) {
+		errno = ENOMEM;
+	}
+	return rc;
 }
 
-static int debug_memory_check_actual (void *address, const char *command, const char *func, const char *file, const int line)
+static void debug_preload_release (void *caller, int kind, size_t size, void *address)
 {
-	int rcu;
-	int rco;
-	struct hmemory_memory *m;
-#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	khiter_t k;
-#endif
-	if (address == NULL) {
-		return 0;
+	int entered;
+	struct hmemory_caller *s;
+	if (address == NULL || debug_preload_arena_contains(address)) {
+		return;
 	}
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-	HASH_FIND_PTR(debug_memory, &address, m);
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	k = kh_get(memory, debug_memory, address);
-	if (k == kh_end(debug_memory)) {
-		m = NULL;
+	entered = debug_preload_enter();
+	if (entered == 0) {
+		if (debug_preload_ready() == 0) {
+			return;
+		}
+		if (hmemory_preload_guard == 0) {
+			debug_preload_early_forget(address);
+		}
+		if (!debug_preload_nested(address)) {
+			hmemory_preload_real.free(address);
+			return;
+		}
+	}
+	s = debug_caller_site(caller);
+	/* the loader also releases blocks its minimal allocator handed out */
+	if (entered == 1 && s->ignore && debug_memory_find(address - hmemory_signature_size, NULL, NULL, NULL) != 0) {
+		hmemory_lock();
+		debug_preload_passed(address);
+		hmemory_unlock();
+		hmemory_preload_real.free(address);
+		debug_preload_leave();
+		return;
+	}
+	if (kind == HMEMORY_KIND_MALLOC) {
+		HMEMORY_FUNCTION_NAME(free_actual)(s->func, s->file, s->line, address);
 	} else {
-		m = kh_val(debug_memory, k);
+		HMEMORY_FUNCTION_NAME(delete_actual)(s->func, s->file, s->line, kind == HMEMORY_KIND_NEW_ARRAY, size, address);
 	}
-#endif
-	if (m != NULL) {
-		goto found_m;
+	if (entered == 1) {
+		debug_preload_leave();
 	}
-	hdebug_lock();
-	hinfof("%s with invalid address (%p)", command, address);
-	hinfof("    at: %s (%s:%d)", func, file, line);
-	debug_dump_callstack("       ");
-	hinfof("  ");
-	hinfof("  if it is certain that program is memory bug free, then hmemory");
-	hinfof("  may have a serious bug that needs to be fixed urgent. please ");
-	hinfof("  inform author");
-	hinfof("    at: alper.akcan@gmail.com");
-	hdebug_unlock();
-	hassert((m != NULL) && "invalid address");
-	return -1;
-found_m:
-	hdebug_lock();
-	rcu = memcmp(m->address, &hmemory_signature, hmemory_signature_size);
-	if (rcu != 0) {
-		hinfof("%s with corrupted address (%p), underflow", command, address);
-		hinfof("    at: %s (%s:%d)", func, file, line);
-		debug_dump_callstack("       ");
+}
+
+static void * debug_preload_memalign (void *caller, const char *command, int kind, size_t alignment, size_t size)
+{
+	void *rc;
+	struct hmemory_caller *s;
+	if (debug_preload_enter() == 0) {
+		if (debug_preload_ready() == 0) {
+			return debug_preload_arena_alloc(alignment, size);
+		}
+		rc = hmemory_preload_real.memalign(alignment, size);
+		if (hmemory_preload_guard == 0) {
+			debug_preload_pass(rc);
+		}
+		return rc;
 	}
-	rco = memcmp(m->address + m->size - hmemory_signature_size, &hmemory_signature, hmemory_signature_size);
-	if (rco != 0) {
-		hinfof("%s with corrupted address (%p), overflow", command, address);
-		hinfof("    at: %s (%s:%d)", func, file, line);
-		debug_dump_callstack("       ");
+	s = debug_caller_site(caller);
+	if (s->ignore) {
+		rc = hmemory_preload_real.memalign(alignment, size);
+		debug_preload_pass(rc);
+		debug_preload_leave();
+		return rc;
 	}
-	hdebug_unlock();
-	hassert(((rcu == 0) && (rco == 0)) && "memory corruption");
-	return 0;
+	rc = memalign_actual(command, s->func, s->file, s->line, command, kind, alignment, size);
+	debug_preload_leave();
+	if (rc == NULL) {
+		errno = ENOMEM;
+	}
+	return rc;
 }
 
-static int debug_memory_check (void *address, const char *command, const char *func, const char *file, const int line)
+void * malloc (size_t size)
 {
-	hmemory_lock();
-	debug_memory_check_actual(address, command, func, file, line);
-	hmemory_unlock();
-	return 0;
+	return debug_preload_malloc(__builtin_return_address(0), size);
 }
 
-static int debug_memory_overlap (void *s1, const void *s2, size_t len, const char *command, const char *func, const char *file, const int line)
+void * calloc (size_t nmemb, size_t size)
 {
-	void *e1;
-	e1 = s1 + len;
-	if (s2 >= s1 && s2 <= e1) {
-		hdebug_lock();
-		hinfof("%s with overlapping memory", command);
-		hinfof("    at: %s (%s:%d)", func, file, line);
-		debug_dump_callstack("       ");
-		hdebug_unlock();
-		hassert((e1 <= s2) && "memory overlap");
+	return debug_preload_calloc(__builtin_return_address(0), nmemb, size);
+}
+
+void * realloc (void *address, size_t size)
+{
+	return debug_preload_realloc(__builtin_return_address(0), address, size);
+}
+
+void * reallocarray (void *address, size_t nmemb, size_t size)
+{
+	size_t total;
+	if (__builtin_mul_overflow(nmemb, size, &total)) {
+		errno = ENOMEM;
+		return NULL;
 	}
-	return 0;
+	return debug_preload_realloc(__builtin_return_address(0), address, total);
 }
 
-static int debug_memory_del (void *address, const char *command, const char *func, const char *file, const int line)
+void free (void *address)
 {
-#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	khiter_t k;
-#endif
-	struct hmemory_memory *m;
-	if (address == NULL) {
-		return 0;
+	debug_preload_release(__builtin_return_address(0), HMEMORY_KIND_MALLOC, 0, address);
+}
+
+void * memalign (size_t alignment, size_t size)
+{
+	size_t power;
+	power = debug_alignment_round(alignment);
+	if (power == 0) {
+		errno = EINVAL;
+		return NULL;
 	}
-	hmemory_lock();
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-	HASH_FIND_PTR(debug_memory, &address, m);
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	k = kh_get(memory, debug_memory, address);
-	if (k == kh_end(debug_memory)) {
-		m = NULL;
-	} else {
-		m = kh_val(debug_memory, k);
+	return debug_preload_memalign(__builtin_return_address(0), "memalign", HMEMORY_KIND_MALLOC, power, size);
+}
+
+void * aligned_alloc (size_t alignment, size_t size)
+{
+	if (!debug_power_of_two(alignment)) {
+		errno = EINVAL;
+		return NULL;
 	}
-#endif
-	if (m != NULL) {
-		goto found_m;
+	return debug_preload_memalign(__builtin_return_address(0), "aligned_alloc", HMEMORY_KIND_MALLOC, alignment, size);
+}
+
+int posix_memalign (void **memptr, size_t alignment, size_t size)
+{
+	void *rc;
+	if (!debug_power_of_two(alignment) || (alignment % sizeof(void *)) != 0) {
+		return EINVAL;
 	}
-	hdebug_lock();
-	hinfof("%s with invalid address (%p)", command, address);
-	hinfof("    at: %s (%s:%d)", func, file, line);
-	debug_dump_callstack("       ");
-	hinfof("  ");
-	hinfof("  if it is certain that program is memory bug free, then hmemory");
-	hinfof("  may have a serious bug that needs to be fixed urgent. please ");
-	hinfof("  inform author");
-	hinfof("    at: alper.akcan@gmail.com");
-	hdebug_unlock();
-	hassert((m != NULL) && "invalid address");
-	hmemory_unlock();
-	return -1;
-found_m:
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-	HASH_DEL(debug_memory, m);
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	kh_del(memory, debug_memory, k);
-#endif
-	hdebugf("%s deleted memory: %s, address: %p, size: %zd, func: %s, file: %s, line: %d", command, m->name, m->address, m->size, m->func, m->file, m->line);
-	memory_current -= (m->size - (hmemory_signature_size * 2));
-	free(m);
-	hmemory_unlock();
+	rc = debug_preload_memalign(__builtin_return_address(0), "posix_memalign", HMEMORY_KIND_MALLOC, alignment, size);
+	if (rc == NULL) {
+		return ENOMEM;
+	}
+	*memptr = rc;
 	return 0;
 }
 
-static void * hmemory_worker (void *arg)
+void * valloc (size_t size)
 {
-	int check;
-	unsigned int v;
-	struct timeval tval;
-	struct timespec tspec;
-	struct hmemory_memory *m;
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-	struct hmemory_memory *nm;
-#endif
-	(void) arg;
-	while (1) {
-		check = 1;
-		v = hmemory_getenv_int(HMEMORY_CHECK_INTERVAL_NAME);
-		if (v == (unsigned int) -1) {
-			check = 0;
-			v = HMEMORY_CHECK_INTERVAL;
-		}
-		gettimeofday(&tval, NULL);
-		tspec.tv_sec = tval.tv_sec + (v / 1000);
-		tspec.tv_nsec = (tval.tv_usec + ((v % 1000) * 1000)) * 1000;
-		if (tspec.tv_nsec >= 1000000000) {
-			tspec.tv_sec += 1;
-			tspec.tv_nsec -= 1000000000;
-		}
-		hmemory_lock();
-		if (hmemory_worker_running == 1) {
-			pthread_cond_timedwait(&hmemory_cond, &hmemory_mutex, &tspec);
-		}
-		if (hmemory_worker_running == 0) {
-			hmemory_unlock();
-			break;
-		}
-		if (check == 0) {
-			hmemory_unlock();
-			continue;
-		}
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-		HASH_ITER(hh, debug_memory, m, nm) {
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-		kh_foreach_value(debug_memory, m,
-#endif
-			debug_memory_check_actual(m->address, "worker check", __FUNCTION__, __FILE__, __LINE__);
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-		}
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-		)
-#endif
-		hinfof("memory information:")
-		hinfof("    current: %llu bytes (%.02f mb)", memory_current, ((double) memory_current) / (1024.00 * 1024.00));
-		hinfof("    peak   : %llu bytes (%.02f mb)", memory_peak, ((double) memory_peak) / (1024.00 * 1024.00));
-		hinfof("    total  : %llu bytes (%.02f mb)", memory_total, ((double) memory_total) / (1024.00 * 1024.00));
-		hmemory_unlock();
-	}
-	return NULL;
+	return debug_preload_memalign(__builtin_return_address(0), "valloc", HMEMORY_KIND_MALLOC, sysconf(_SC_PAGESIZE), size);
 }
 
-static void __attribute__ ((constructor)) hmemory_init (void)
+void * pvalloc (size_t size)
 {
-	int rc;
-	hmemory_lock();
-#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	debug_memory = kh_init(memory);
-#endif
-	hmemory_worker_started = 1;
-	hmemory_worker_running = 1;
-	rc = pthread_create(&hmemory_thread, NULL, hmemory_worker, NULL);
-	if (rc != 0) {
-		herrorf("failed to create worker");
-		hmemory_worker_started = 0;
-		hmemory_worker_running = 0;
+	size_t page;
+	page = sysconf(_SC_PAGESIZE);
+	if (debug_page_round(&size, page) != 0) {
+		errno = ENOMEM;
+		return NULL;
 	}
-	hmemory_unlock();
+	return debug_preload_memalign(__builtin_return_address(0), "pvalloc", HMEMORY_KIND_MALLOC, page, size);
 }
 
-static void __attribute__ ((destructor)) hmemory_fini (void)
+size_t malloc_usable_size (void *address)
 {
-	int show_reachable;
-	struct hmemory_memory *m;
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-	struct hmemory_memory *nm;
-#endif
-	hmemory_lock();
-	if (hmemory_worker_running == 1) {
-		hmemory_worker_running = 0;
+	int rc;
+	size_t size;
+	if (address == NULL) {
+		return 0;
 	}
-	pthread_cond_signal(&hmemory_cond);
-	hmemory_unlock();
-	pthread_join(hmemory_thread, NULL);
-	hmemory_lock();
-	hdebug_lock();
-	hinfof("memory information:")
-	hinfof("    current: %llu bytes (%.02f mb)", memory_current, ((double) memory_current) / (1024.00 * 1024.00));
-	hinfof("    peak   : %llu bytes (%.02f mb)", memory_peak, ((double) memory_peak) / (1024.00 * 1024.00));
-	hinfof("    total  : %llu bytes (%.02f mb)", memory_total, ((double) memory_total) / (1024.00 * 1024.00));
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-	hinfof("    leaks  : %d items", HASH_COUNT(debug_memory));
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	hinfof("    leaks  : %d items", kh_size(debug_memory));
-#endif
-	show_reachable = hmemory_getenv_int(HMEMORY_SHOW_REACHABLE_NAME);
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-	if (HASH_COUNT(debug_memory) > 0 && show_reachable == 1) {
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	if (kh_size(debug_memory) > 0 && show_reachable == 1) {
-#endif
-		hinfof("  memory leaks:");
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-		HASH_ITER(hh, debug_memory, m, nm) {
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-		kh_foreach_value(debug_memory, m,
-#endif
-			hinfof("    - %zd bytes at: %p %s (%s:%u)", m->size, m->address + hmemory_signature_size, m->func, m->file, m->line);
-#if defined(HMEMORY_HASH_UTHASH) && (HMEMORY_HASH_UTHASH == 1)
-			HASH_DEL(debug_memory, m);
-			free(m->address);
-			free(m);
+	if (debug_preload_arena_contains(address)) {
+		return debug_preload_arena_size(address);
+	}
+	if (debug_preload_enter() == 0) {
+		if (debug_preload_ready() == 0) {
+			return 0;
 		}
-#elif defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-			free(m->address);
-			free(m);
-		)
+		if (hmemory_preload_guard == 0 || __atomic_load_n(&hmemory_preload_active, __ATOMIC_ACQUIRE) == 0) {
+			return hmemory_preload_real.malloc_usable_size(address);
+		}
+		rc = debug_memory_find(address - hmemory_signature_size, NULL, &size, NULL);
+	} else {
+		rc = debug_memory_find(address - hmemory_signature_size, NULL, &size, NULL);
+		debug_preload_leave();
+	}
+	if (rc != 0) {
+		return hmemory_preload_real.malloc_usable_size(address);
+	}
+	return size - (hmemory_signature_size * 2);
+}
+
 #endif
-		hassert(0 && "memory leak");
+
+/*
+ * entry points of the c++ operators in hmemory-new.cpp, caller is the return
+ * address of the operator. tracking is started on first use, as operators may
+ * be called by constructors of other objects before hmemory_init, and stops
+ * with hmemory_fini; blocks released after that are left to the process exit.
+ */
+void * HMEMORY_FUNCTION_NAME(operator_new_actual) (void *caller, int array, size_t alignment, size_t size)
+{
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+	return debug_preload_memalign(caller, (array) ? "new[]" : "new", (array) ? HMEMORY_KIND_NEW_ARRAY : HMEMORY_KIND_NEW, alignment, size);
+#elif defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	void *rc;
+	struct hmemory_caller *s;
+	hmemory_init();
+	if (__atomic_load_n(&hmemory_finished, __ATOMIC_ACQUIRE)) {
+		return (posix_memalign(&rc, (alignment < sizeof(void *)) ? sizeof(void *) : alignment, size) == 0) ? rc : NULL;
 	}
-#if defined(HMEMORY_HASH_KHASH) && (HMEMORY_HASH_KHASH == 1)
-	kh_destroy(memory, debug_memory);
+	s = debug_caller_site(caller);
+	return HMEMORY_FUNCTION_NAME(new_actual)(s->func, s->file, s->line, (array) ? "new[]" : "new", array, alignment, size);
+#else
+	(void) caller;
+	return HMEMORY_FUNCTION_NAME(new_actual)(NULL, NULL, 0, NULL, array, alignment, size);
 #endif
-	hdebug_unlock();
-	hmemory_unlock();
 }
 
+void HMEMORY_FUNCTION_NAME(operator_delete_actual) (void *caller, int array, size_t size, void *address)
+{
+#if defined(HMEMORY_PRELOAD) && (HMEMORY_PRELOAD == 1)
+	debug_preload_release(caller, (array) ? HMEMORY_KIND_NEW_ARRAY : HMEMORY_KIND_NEW, size, address);
+#elif defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	struct hmemory_caller *s;
+	if (address == NULL || __atomic_load_n(&hmemory_finished, __ATOMIC_ACQUIRE)) {
+		return;
+	}
+	s = debug_caller_site(caller);
+	HMEMORY_FUNCTION_NAME(delete_actual)(s->func, s->file, s->line, array, size, address);
+#else
+	(void) caller;
+	HMEMORY_FUNCTION_NAME(delete_actual)(NULL, NULL, 0, array, size, address);
 #endif
+}
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1    -I../src -M fail-05.c | sed 's,\(fail-05\.o\) *:,.fail-05/ .fail-05/fail-05.d: ,' > .fail-05/fail-05.d; cp -rf .fail-05/fail-05.d .fail-05/fail-05.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .fail-05/fail-05.d >> .fail-05/fail-05.d.p; mv .fail-05/fail-05.d.p .fail-05/fail-05.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1    -I../src -M fail-11.c | sed 's,\(fail-11\.o\) *:,.fail-11/ .fail-11/fail-11.d: ,' > .fail-11/fail-11.d; cp -rf .fail-11/fail-11.d .fail-11/fail-11.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .fail-11/fail-11.d >> .fail-11/fail-11.d.p; mv .fail-11/fail-11.d.p .fail-11/fail-11.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O1 -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M fail-21.c | sed 's,\(fail-21\.o\) *:,.fail-21-debug/ .fail-21-debug/fail-21.d: ,' > .fail-21-debug/fail-21.d; cp -rf .fail-21-debug/fail-21.d .fail-21-debug/fail-21.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .fail-21-debug/fail-21.d >> .fail-21-debug/fail-21.d.p; mv .fail-21-debug/fail-21.d.p .fail-21-debug/fail-21.d
@@ -0,0 +1 @@
+g++  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1   -o .fail-22-debug/fail-22-debug .fail-22-debug/fail-22.o ../src/libhmemory.o ../src/libhmemory-new.o -lpthread -lpthread -ldl 
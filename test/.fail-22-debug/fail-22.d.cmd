@@ -0,0 +1 @@
+g++  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O1 -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M fail-22.cpp | sed 's,\(fail-22\.o\) *:,.fail-22-debug/ .fail-22-debug/fail-22.d: ,' > .fail-22-debug/fail-22.d
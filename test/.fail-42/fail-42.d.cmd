@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1    -I../src -M fail-42.c | sed 's,\(fail-42\.o\) *:,.fail-42/ .fail-42/fail-42.d: ,' > .fail-42/fail-42.d; cp -rf .fail-42/fail-42.d .fail-42/fail-42.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .fail-42/fail-42.d >> .fail-42/fail-42.d.p; mv .fail-42/fail-42.d.p .fail-42/fail-42.d
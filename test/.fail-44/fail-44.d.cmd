@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1    -I../src -M fail-44.c | sed 's,\(fail-44\.o\) *:,.fail-44/ .fail-44/fail-44.d: ,' > .fail-44/fail-44.d; cp -rf .fail-44/fail-44.d .fail-44/fail-44.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .fail-44/fail-44.d >> .fail-44/fail-44.d.p; mv .fail-44/fail-44.d.p .fail-44/fail-44.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O1 -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M fail-46.c | sed 's,\(fail-46\.o\) *:,.fail-46-debug/ .fail-46-debug/fail-46.d: ,' > .fail-46-debug/fail-46.d; cp -rf .fail-46-debug/fail-46.d .fail-46-debug/fail-46.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .fail-46-debug/fail-46.d >> .fail-46-debug/fail-46.d.p; mv .fail-46-debug/fail-46.d.p .fail-46-debug/fail-46.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O1 -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M success-02.c | sed 's,\(success-02\.o\) *:,.success-02-debug/ .success-02-debug/success-02.d: ,' > .success-02-debug/success-02.d; cp -rf .success-02-debug/success-02.d .success-02-debug/success-02.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .success-02-debug/success-02.d >> .success-02-debug/success-02.d.p; mv .success-02-debug/success-02.d.p .success-02-debug/success-02.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1    -I../src -M success-04.c | sed 's,\(success-04\.o\) *:,.success-04/ .success-04/success-04.d: ,' > .success-04/success-04.d; cp -rf .success-04/success-04.d .success-04/success-04.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .success-04/success-04.d >> .success-04/success-04.d.p; mv .success-04/success-04.d.p .success-04/success-04.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O1 -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M success-07.c | sed 's,\(success-07\.o\) *:,.success-07-debug/ .success-07-debug/success-07.d: ,' > .success-07-debug/success-07.d; cp -rf .success-07-debug/success-07.d .success-07-debug/success-07.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .success-07-debug/success-07.d >> .success-07-debug/success-07.d.p; mv .success-07-debug/success-07.d.p .success-07-debug/success-07.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1    -I../src -M success-12.c | sed 's,\(success-12\.o\) *:,.success-12/ .success-12/success-12.d: ,' > .success-12/success-12.d; cp -rf .success-12/success-12.d .success-12/success-12.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .success-12/success-12.d >> .success-12/success-12.d.p; mv .success-12/success-12.d.p .success-12/success-12.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1    -I../src -M success-42.c | sed 's,\(success-42\.o\) *:,.success-42/ .success-42/success-42.d: ,' > .success-42/success-42.d; cp -rf .success-42/success-42.d .success-42/success-42.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .success-42/success-42.d >> .success-42/success-42.d.p; mv .success-42/success-42.d.p .success-42/success-42.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O1 -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M success-43.c | sed 's,\(success-43\.o\) *:,.success-43-debug/ .success-43-debug/success-43.d: ,' > .success-43-debug/success-43.d; cp -rf .success-43-debug/success-43.d .success-43-debug/success-43.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .success-43-debug/success-43.d >> .success-43-debug/success-43.d.p; mv .success-43-debug/success-43.d.p .success-43-debug/success-43.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1    -I../src -M success-45.c | sed 's,\(success-45\.o\) *:,.success-45/ .success-45/success-45.d: ,' > .success-45/success-45.d; cp -rf .success-45/success-45.d .success-45/success-45.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .success-45/success-45.d >> .success-45/success-45.d.p; mv .success-45/success-45.d.p .success-45/success-45.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1    -I../src -M success-47.c | sed 's,\(success-47\.o\) *:,.success-47/ .success-47/success-47.d: ,' > .success-47/success-47.d; cp -rf .success-47/success-47.d .success-47/success-47.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .success-47/success-47.d >> .success-47/success-47.d.p; mv .success-47/success-47.d.p .success-47/success-47.d
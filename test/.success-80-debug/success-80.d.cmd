@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1  -O1 -DHMEMORY_DEBUG=1 -include ../src/hmemory.h  -I../src -M success-80.c | sed 's,\(success-80\.o\) *:,.success-80-debug/ .success-80-debug/success-80.d: ,' > .success-80-debug/success-80.d; cp -rf .success-80-debug/success-80.d .success-80-debug/success-80.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .success-80-debug/success-80.d >> .success-80-debug/success-80.d.p; mv .success-80-debug/success-80.d.p .success-80-debug/success-80.d
@@ -0,0 +1 @@
+gcc  -DHMEMORY_ENABLE_CALLSTACK=0 -Wall -Wextra -pipe -g3 -O2 -fPIC -fsigned-char -fno-strict-aliasing -D_GNU_SOURCE -D_FILE_OFFSET_BITS=64 -D_LARGEFILE_SOURCE -fno-math-errno -fno-trapping-math -fassociative-math -fno-signed-zeros -D__LINUX__=1    -I../src -M success-82.c | sed 's,\(success-82\.o\) *:,.success-82/ .success-82/success-82.d: ,' > .success-82/success-82.d; cp -rf .success-82/success-82.d .success-82/success-82.d.p; sed -e 's/#.*//' -e 's/^[^:]*: *//' -e 's/ *\$//' -e '/^$/ d' -e 's/$/ :/' < .success-82/success-82.d >> .success-82/success-82.d.p; mv .success-82/success-82.d.p .success-82/success-82.d
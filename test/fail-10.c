@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct node {
+	struct node *next;
+	char data[48];
+};
+
+static struct node * __attribute__ ((noinline)) build (int count)
+{
+	int i;
+	struct node *n;
+	struct node *head;
+	head = NULL;
+	for (i = 0; i < count; i++) {
+		n = malloc(sizeof(struct node));
+		if (n == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			exit(-1);
+		}
+		memset(n->data, 0, sizeof(n->data));
+		n->next = head;
+		head = n;
+	}
+	return head;
+}
+
+/* clear stale pointers left in dead stack frames, the scan is conservative */
+static void __attribute__ ((noinline)) scrub (void)
+{
+	volatile char stack[16384];
+	memset((char *) stack, 0, sizeof(stack));
+}
+
+int main (int argc, char *argv[])
+{
+	struct node *lost;
+	(void) argc;
+	(void) argv;
+	lost = build(4);
+	if (lost == NULL) {
+		fprintf(stderr, "build failed\n");
+		exit(-1);
+	}
+	lost = NULL;
+	scrub();
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	{
+		struct hmemory_leaks leaks;
+		hmemory_leaks(&leaks);
+	}
+#endif
+	return 0;
+}
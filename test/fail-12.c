@@ -0,0 +1,33 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main (int argc, char *argv[])
+{
+	int r;
+	char *rc;
+	(void) argc;
+	(void) argv;
+	r = asprintf(&rc, "%s-%d", "abc", 42);
+	if (r != 6 || strcmp(rc, "abc-42") != 0) {
+		fprintf(stderr, "asprintf failed\n");
+		exit(-1);
+	}
+	free(rc);
+	r = asprintf(&rc, "%0*d", 5000, 7);
+	if (r != 5000 || rc[4999] != '7') {
+		fprintf(stderr, "asprintf failed\n");
+		exit(-1);
+	}
+	return 0;
+}
@@ -0,0 +1,40 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SIZE		(2 * 1024 * 1024)
+
+int main (int argc, char *argv[])
+{
+	char *rc;
+	char *tmp;
+	volatile size_t offset = SIZE * 32;
+	(void) argc;
+	(void) argv;
+	rc = malloc(SIZE);
+	if (rc == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		exit(-1);
+	}
+	memset(rc, 'a', SIZE);
+	tmp = realloc(rc, SIZE * 32);
+	if (tmp == NULL) {
+		fprintf(stderr, "realloc failed\n");
+		exit(-1);
+	}
+	rc = tmp;
+	rc[offset] = 'a';
+	free(rc);
+	return 0;
+}
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define THREADS		4
+#define BLOCKS		10000
+
+static void *blocks[THREADS][BLOCKS];
+
+static void * producer (void *arg)
+{
+	int i;
+	void **b;
+	b = arg;
+	for (i = 0; i < BLOCKS; i++) {
+		b[i] = malloc(16 + (i % 512));
+		if (b[i] == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			exit(-1);
+		}
+	}
+	return NULL;
+}
+
+static void * consumer (void *arg)
+{
+	int i;
+	void **b;
+	b = arg;
+	for (i = 0; i < BLOCKS - 1; i++) {
+		free(b[i]);
+	}
+	return NULL;
+}
+
+int main (int argc, char *argv[])
+{
+	int i;
+	pthread_t threads[THREADS];
+	(void) argc;
+	(void) argv;
+	for (i = 0; i < THREADS; i++) {
+		pthread_create(&threads[i], NULL, producer, blocks[i]);
+	}
+	for (i = 0; i < THREADS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	for (i = 0; i < THREADS; i++) {
+		pthread_create(&threads[i], NULL, consumer, blocks[(i + 1) % THREADS]);
+	}
+	for (i = 0; i < THREADS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	return 0;
+}
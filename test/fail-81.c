@@ -0,0 +1,97 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/wait.h>
+
+#define THREADS		4
+#define FORKS		16
+
+static volatile int running = 1;
+
+static void * worker (void *arg)
+{
+	void *b;
+	(void) arg;
+	while (running) {
+		b = malloc(64);
+		if (b == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			exit(-1);
+		}
+		free(b);
+	}
+	return NULL;
+}
+
+static int child (void)
+{
+	int i;
+	void * volatile b;
+	for (i = 0; i < 1000; i++) {
+		b = malloc(128);
+		if (b == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			return -1;
+		}
+		memset(b, 0, 128);
+		free(b);
+	}
+	free(b);
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	{
+		struct hmemory_leaks leaks;
+		if (hmemory_leaks(&leaks) != 0) {
+			fprintf(stderr, "leak check failed\n");
+			return -1;
+		}
+	}
+#endif
+	return 0;
+}
+
+int main (int argc, char *argv[])
+{
+	int i;
+	int rc;
+	int status;
+	pid_t pid;
+	pthread_t threads[THREADS];
+	(void) argc;
+	(void) argv;
+	rc = 0;
+	for (i = 0; i < THREADS; i++) {
+		pthread_create(&threads[i], NULL, worker, NULL);
+	}
+	for (i = 0; i < FORKS; i++) {
+		pid = fork();
+		if (pid < 0) {
+			fprintf(stderr, "fork failed\n");
+			exit(-1);
+		}
+		if (pid == 0) {
+			_exit(child());
+		}
+		if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			fprintf(stderr, "child %d failed\n", i);
+			rc = -1;
+			break;
+		}
+	}
+	running = 0;
+	for (i = 0; i < THREADS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	return rc;
+}
@@ -0,0 +1,79 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <malloc.h>
+
+static void check (const char *name, void *rc, size_t alignment, size_t size)
+{
+	if (rc == NULL) {
+		fprintf(stderr, "%s failed\n", name);
+		exit(-1);
+	}
+	if (((uintptr_t) rc) % alignment != 0) {
+		fprintf(stderr, "%s is not aligned to %zd\n", name, alignment);
+		exit(-1);
+	}
+	if (malloc_usable_size(rc) < size) {
+		fprintf(stderr, "%s usable size is less than %zd\n", name, size);
+		exit(-1);
+	}
+	memset(rc, 0, size);
+}
+
+int main (int argc, char *argv[])
+{
+	int r;
+	void *rc;
+	size_t page;
+	(void) argc;
+	(void) argv;
+	page = sysconf(_SC_PAGESIZE);
+	rc = malloc(24);
+	check("malloc", rc, __alignof__(max_align_t), 24);
+	rc = realloc(rc, 1000);
+	check("realloc", rc, __alignof__(max_align_t), 1000);
+	rc = reallocarray(rc, 100, 20);
+	check("reallocarray", rc, __alignof__(max_align_t), 2000);
+	free(rc);
+	rc = calloc(3, 7);
+	check("calloc", rc, __alignof__(max_align_t), 21);
+	free(rc);
+	rc = strdup(argv[0]);
+	check("strdup", rc, __alignof__(max_align_t), strlen(argv[0]) + 1);
+	free(rc);
+	r = posix_memalign(&rc, 64, 100);
+	if (r != 0) {
+		fprintf(stderr, "posix_memalign failed\n");
+		exit(-1);
+	}
+	check("posix_memalign", rc, 64, 100);
+	rc = realloc(rc, 200);
+	check("realloc", rc, __alignof__(max_align_t), 200);
+	free(rc);
+	rc = aligned_alloc(64, 128);
+	check("aligned_alloc", rc, 64, 128);
+	free(rc);
+	rc = memalign(page, 100);
+	check("memalign", rc, page, 100);
+	free(rc);
+	rc = valloc(100);
+	check("valloc", rc, page, 100);
+	free(rc);
+	rc = pvalloc(100);
+	check("pvalloc", rc, page, page);
+	free(rc);
+	return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main (int argc, char *argv[])
+{
+	int i;
+	FILE *fp;
+	char *rc;
+	size_t n;
+	ssize_t len;
+	char text[4096];
+	(void) argc;
+	(void) argv;
+	memset(text, 'a', sizeof(text) - 1);
+	text[sizeof(text) - 1] = '\0';
+	for (i = 0; i < 8; i++) {
+		text[i * 16] = '\n';
+	}
+	text[1024] = ',';
+	fp = fmemopen(text, strlen(text), "r");
+	if (fp == NULL) {
+		fprintf(stderr, "fmemopen failed\n");
+		exit(-1);
+	}
+	rc = NULL;
+	n = 0;
+	while ((len = getline(&rc, &n, fp)) > 0) {
+		if ((size_t) len != strlen(rc) || n <= (size_t) len) {
+			fprintf(stderr, "getline failed\n");
+			exit(-1);
+		}
+	}
+	rewind(fp);
+	errno = EINVAL;
+	while ((len = getdelim(&rc, &n, ',', fp)) > 0) {
+		if ((size_t) len != strlen(rc) || n <= (size_t) len) {
+			fprintf(stderr, "getdelim failed\n");
+			exit(-1);
+		}
+	}
+	fclose(fp);
+	free(rc);
+	return 0;
+}
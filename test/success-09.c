@@ -0,0 +1,44 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct node {
+	struct node *next;
+	char data[48];
+};
+
+struct node *list;
+
+int main (int argc, char *argv[])
+{
+	int i;
+	struct node *n;
+	(void) argc;
+	(void) argv;
+	for (i = 0; i < 16; i++) {
+		n = malloc(sizeof(struct node));
+		if (n == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			exit(-1);
+		}
+		memset(n->data, 0, sizeof(n->data));
+		n->next = list;
+		list = n;
+	}
+	while (list != NULL) {
+		n = list->next;
+		free(list);
+		list = n;
+	}
+	return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MASK	((uintptr_t) 0x5a5a5a5a5a5a5a5aULL)
+
+struct node {
+	struct node *next;
+	char data[48];
+};
+
+struct node *list;
+
+static struct node * __attribute__ ((noinline)) build (int count)
+{
+	int i;
+	struct node *n;
+	struct node *head;
+	head = NULL;
+	for (i = 0; i < count; i++) {
+		n = malloc(sizeof(struct node));
+		if (n == NULL) {
+			fprintf(stderr, "malloc failed\n");
+			exit(-1);
+		}
+		memset(n->data, 0, sizeof(n->data));
+		n->next = head;
+		head = n;
+	}
+	return head;
+}
+
+static void release (struct node *head)
+{
+	struct node *n;
+	while (head != NULL) {
+		n = head->next;
+		free(head);
+		head = n;
+	}
+}
+
+/* clear stale pointers left in dead stack frames, the scan is conservative */
+static void __attribute__ ((noinline)) scrub (void)
+{
+	volatile char stack[16384];
+	memset((char *) stack, 0, sizeof(stack));
+}
+
+int main (int argc, char *argv[])
+{
+	volatile uintptr_t hidden;
+	(void) argc;
+	(void) argv;
+	list = build(4);
+	/* keep the second list only as a masked value, it looks lost */
+	hidden = ((uintptr_t) build(4)) ^ MASK;
+	scrub();
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	{
+		struct hmemory_leaks leaks;
+		if (hmemory_leaks(&leaks) != 0) {
+			fprintf(stderr, "leak check failed\n");
+			exit(-1);
+		}
+		if (leaks.definite_blocks != 1 || leaks.indirect_blocks != 3 || leaks.reachable_blocks < 4) {
+			fprintf(stderr, "leak check mismatch, definite: %llu, indirect: %llu, reachable: %llu\n", leaks.definite_blocks, leaks.indirect_blocks, leaks.reachable_blocks);
+			exit(-1);
+		}
+	}
+#endif
+	release((struct node *) (hidden ^ MASK));
+	release(list);
+	return 0;
+}
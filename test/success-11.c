@@ -0,0 +1,65 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* suppressions are read at startup, the test runs itself again with them */
+static const char *suppressions =
+	"# process lifetime allocations\n"
+	"leak func:leak_forever\n"
+	"leak file:*success-11\n"
+	"error func:ma?n\n"
+	"leak site:unused.c:1\n";
+
+void * __attribute__ ((noinline)) leak_forever (size_t size)
+{
+	return malloc(size);
+}
+
+int main (int argc, char *argv[])
+{
+	int fd;
+	char *rc;
+	char path[] = "/tmp/hmemory-suppressions-XXXXXX";
+	static void *keep;
+	volatile size_t offset = 4;
+	(void) argc;
+	if (getenv("hmemory_suppressions") == NULL) {
+		fd = mkstemp(path);
+		if (fd < 0 || write(fd, suppressions, strlen(suppressions)) != (ssize_t) strlen(suppressions)) {
+			fprintf(stderr, "can not write suppressions\n");
+			exit(-1);
+		}
+		close(fd);
+		setenv("hmemory_suppressions", path, 1);
+		execv(argv[0], argv);
+		fprintf(stderr, "execv failed\n");
+		exit(-1);
+	}
+	unlink(getenv("hmemory_suppressions"));
+	keep = leak_forever(1024);
+	if (keep == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		exit(-1);
+	}
+	keep = NULL;
+	rc = malloc(1024);
+	if (rc == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		exit(-1);
+	}
+	memset(rc, 'a', 1024);
+	memcpy(rc, rc + offset, 8);
+	free(rc);
+	return 0;
+}
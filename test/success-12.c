@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int format (char **strp, const char *fmt, ...)
+{
+	int r;
+	va_list ap;
+	va_start(ap, fmt);
+	r = vasprintf(strp, fmt, ap);
+	va_end(ap);
+	return r;
+}
+
+int main (int argc, char *argv[])
+{
+	int r;
+	char *rc;
+	char *data;
+	(void) argc;
+	(void) argv;
+	data = malloc(8);
+	if (data == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		exit(-1);
+	}
+	memcpy(data, "abcdefgh", 8);
+	rc = strndup(data, 4);
+	if (rc == NULL || strcmp(rc, "abcd") != 0) {
+		fprintf(stderr, "strndup failed\n");
+		exit(-1);
+	}
+	free(rc);
+	rc = strndup(data, 8);
+	if (rc == NULL || strcmp(rc, "abcdefgh") != 0) {
+		fprintf(stderr, "strndup failed\n");
+		exit(-1);
+	}
+	free(rc);
+	free(data);
+	rc = strndup("abc", 1024);
+	if (rc == NULL || strcmp(rc, "abc") != 0) {
+		fprintf(stderr, "strndup failed\n");
+		exit(-1);
+	}
+	free(rc);
+	r = asprintf(&rc, "%s-%d", "abc", 42);
+	if (r != 6 || strcmp(rc, "abc-42") != 0) {
+		fprintf(stderr, "asprintf failed\n");
+		exit(-1);
+	}
+	free(rc);
+	r = asprintf(&rc, "%0*d", 5000, 7);
+	if (r != 5000 || strlen(rc) != 5000 || rc[0] != '0' || rc[4999] != '7') {
+		fprintf(stderr, "asprintf failed\n");
+		exit(-1);
+	}
+	free(rc);
+	r = format(&rc, "%s:%c", "vasprintf", 'x');
+	if (r != 11 || strcmp(rc, "vasprintf:x") != 0) {
+		fprintf(stderr, "vasprintf failed\n");
+		exit(-1);
+	}
+	free(rc);
+	return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+
+struct block {
+	char data[100];
+	block () { memset(data, 0, sizeof(data)); }
+	~block () { data[0] = 1; }
+};
+
+struct alignas(64) line {
+	char data[64];
+};
+
+int main (int argc, char *argv[])
+{
+	int *rc;
+	block *b;
+	line *l;
+	(void) argc;
+	(void) argv;
+	rc = new int;
+	*rc = 0;
+	delete rc;
+	rc = new int[1024];
+	memset(rc, 0, sizeof(int) * 1024);
+	delete[] rc;
+	b = new block;
+	delete b;
+	b = new block[10];
+	delete[] b;
+	l = new line[4];
+	if (((unsigned long) l) % 64 != 0) {
+		fprintf(stderr, "alignment failed\n");
+		exit(-1);
+	}
+	delete[] l;
+	rc = new (std::nothrow) int[16];
+	if (rc == NULL) {
+		fprintf(stderr, "new failed\n");
+		exit(-1);
+	}
+	delete[] rc;
+	return 0;
+}
@@ -0,0 +1,35 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+int main (int argc, char *argv[])
+{
+	char *rc;
+	char *dst;
+	(void) argc;
+	(void) argv;
+	rc = malloc(200000);
+	dst = malloc(65536);
+	if (rc == NULL || dst == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		exit(-1);
+	}
+	memset(rc, 'a', 200000);
+	memcpy(dst, rc + 150000, 50000);
+	snprintf(rc + 199000, 1000, "%s", "hello");
+	strncpy(dst + 65000, rc + 199000, 536);
+	free(dst);
+	free(rc);
+	return 0;
+}
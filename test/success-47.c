@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SIZE		(2 * 1024 * 1024)
+
+static int check (const char *rc, size_t size, char c)
+{
+	size_t i;
+	for (i = 0; i < size; i += 4096) {
+		if (rc[i] != c) {
+			return -1;
+		}
+	}
+	return (rc[size - 1] == c) ? 0 : -1;
+}
+
+int main (int argc, char *argv[])
+{
+	char *rc;
+	char *tmp;
+	(void) argc;
+	(void) argv;
+	rc = malloc(SIZE);
+	if (rc == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		exit(-1);
+	}
+	memset(rc, 'a', SIZE);
+	tmp = realloc(rc, SIZE * 32);
+	if (tmp == NULL || check(tmp, SIZE, 'a') != 0) {
+		fprintf(stderr, "realloc failed\n");
+		exit(-1);
+	}
+	rc = tmp;
+	rc[SIZE * 32 - 1] = 'a';
+	tmp = realloc(rc, SIZE / 2);
+	if (tmp == NULL || check(tmp, SIZE / 2, 'a') != 0) {
+		fprintf(stderr, "realloc failed\n");
+		exit(-1);
+	}
+	rc = tmp;
+	tmp = realloc(rc, 4096);
+	if (tmp == NULL || check(tmp, 4096, 'a') != 0) {
+		fprintf(stderr, "realloc failed\n");
+		exit(-1);
+	}
+	free(tmp);
+	rc = calloc(4, SIZE);
+	if (rc == NULL || check(rc, SIZE * 4, 0) != 0) {
+		fprintf(stderr, "calloc failed\n");
+		exit(-1);
+	}
+	free(rc);
+	return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (c) 2008-2013 Alper Akcan <alper.akcan@gmail.com>
+ *
+ * This program is free software. It comes without any warranty, to
+ * the extent permitted by applicable law. You can redistribute it
+ * and/or modify it under the terms of the Do What The Fuck You Want
+ * To Public License, Version 2, as published by Sam Hocevar. See
+ * http://www.wtfpl.net/ for more details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define THREADS		16
+#define ROUNDS		64
+#define SIZE		60000
+
+static void *blocks[THREADS];
+
+static void * worker (void *arg)
+{
+	void **b;
+	b = arg;
+	*b = malloc(SIZE);
+	if (*b == NULL) {
+		fprintf(stderr, "malloc failed\n");
+		exit(-1);
+	}
+	memset(*b, 0, SIZE);
+	return NULL;
+}
+
+int main (int argc, char *argv[])
+{
+	int i;
+	int r;
+	pthread_t threads[THREADS];
+	(void) argc;
+	(void) argv;
+	for (r = 0; r < ROUNDS; r++) {
+		for (i = 0; i < THREADS; i++) {
+			pthread_create(&threads[i], NULL, worker, &blocks[i]);
+		}
+		for (i = 0; i < THREADS; i++) {
+			pthread_join(threads[i], NULL);
+		}
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+		{
+			struct hmemory_information information;
+			hmemory_information(&information);
+			if (information.current != THREADS * SIZE) {
+				fprintf(stderr, "statistics mismatch, current: %llu\n", information.current);
+				exit(-1);
+			}
+		}
+#endif
+		for (i = 0; i < THREADS; i++) {
+			free(blocks[i]);
+		}
+	}
+#if defined(HMEMORY_DEBUG) && (HMEMORY_DEBUG == 1)
+	{
+		struct hmemory_information information;
+		hmemory_information(&information);
+		if (information.current != 0 || information.blocks != 0 || information.peak < THREADS * SIZE) {
+			fprintf(stderr, "statistics mismatch, current: %llu, peak: %llu, blocks: %llu\n", information.current, information.peak, information.blocks);
+			exit(-1);
+		}
+	}
+#endif
+	return 0;
+}